@@ -0,0 +1,63 @@
+// Compares footprint distances computed on nested snapshots (vector<vector<double>>,
+// std::pow per element, as novelty used to do) with the flat aligned buffers and the
+// vectorized kernel (squaredDistance), which novelty uses through computeNovelty and the
+// archive KD-tree.
+// usage: footprint [archiveSize] [nbSnapshots] [snapshotSize]
+#include <iostream>
+#include "../gaga.hpp"
+
+static double nestedDistance(const GAGA::fpType &f0, const GAGA::fpType &f1) {
+	double d = 0;
+	for (size_t i = 0; i < f0.size(); ++i)
+		for (size_t j = 0; j < f0[i].size(); ++j) d += std::pow(f0[i][j] - f1[i][j], 2);
+	return sqrt(d);
+}
+
+template <typename F> double timeIt(F &&f) {
+	auto t0 = std::chrono::high_resolution_clock::now();
+	f();
+	auto t1 = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration<double>(t1 - t0).count();
+}
+
+int main(int argc, char **argv) {
+	size_t archiveSize = argc > 1 ? std::stoul(argv[1]) : 20000;
+	size_t nbSnapshots = argc > 2 ? std::stoul(argv[2]) : 10;
+	size_t snapshotSize = argc > 3 ? std::stoul(argv[3]) : 8;
+	std::default_random_engine rnd(0);
+	std::uniform_real_distribution<double> d(-1.0, 1.0);
+	auto randomFootprint = [&]() {
+		GAGA::fpType f(nbSnapshots, std::vector<double>(snapshotSize));
+		for (auto &s : f)
+			for (auto &x : s) x = d(rnd);
+		return f;
+	};
+	std::vector<GAGA::fpType> nested;
+	std::vector<GAGA::FlatFootprint> flat;
+	for (size_t i = 0; i < archiveSize; ++i) {
+		nested.push_back(randomFootprint());
+		flat.emplace_back(nested.back());
+	}
+	GAGA::fpType query = randomFootprint();
+	GAGA::FlatFootprint flatQuery(query);
+
+	// one novelty query = distances to the whole archive
+	const int nbQueries = 50;
+	double nestedSum = 0, flatSum = 0;
+	double nestedTime = timeIt([&]() {
+		for (int q = 0; q < nbQueries; ++q)
+			for (const auto &f : nested) nestedSum += nestedDistance(query, f);
+	});
+	double flatTime = timeIt([&]() {
+		for (int q = 0; q < nbQueries; ++q)
+			for (const auto &f : flat) flatSum += sqrt(GAGA::squaredDistance(flatQuery, f));
+	});
+
+	std::cout << "archive = " << archiveSize << ", footprint = " << nbSnapshots << "x"
+	          << snapshotSize << " (checksums " << nestedSum << " / " << flatSum << ")"
+	          << std::endl;
+	std::cout << "nested : " << nestedTime / nbQueries * 1e3 << " ms/query" << std::endl;
+	std::cout << "flat   : " << flatTime / nbQueries * 1e3 << " ms/query" << std::endl;
+	std::cout << "speedup: x" << nestedTime / flatTime << std::endl;
+	return 0;
+}
@@ -0,0 +1,85 @@
+// Memory allocated per generation with a large DNA (dnaSize doubles per individual):
+// "copy" is the former classicNextGen, which copied the population into lastGen and the
+// offspring into the population; "swap" is GA::classicNextGen, which recycles the
+// individuals of the generation before the last one and rotates the buffers.
+// usage: generation [popSize] [dnaSize] [nbGenerations]
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include "../gaga.hpp"
+
+static std::atomic<size_t> allocatedBytes{0};
+
+// replaced allocation functions. They aren't inlined, otherwise GCC sees std::free called on
+// memory from operator new (or the reverse) and warns about mismatched new/delete.
+__attribute__((noinline)) void *operator new(size_t n) {
+	allocatedBytes += n;
+	if (void *p = std::malloc(n)) return p;
+	throw std::bad_alloc();
+}
+__attribute__((noinline)) void operator delete(void *p) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+struct BigDNA {
+	std::vector<double> values;
+	BigDNA() {}
+	explicit BigDNA(size_t n) : values(n, 0.0) {}
+	explicit BigDNA(const std::string &) {}
+	std::string serialize() const { return std::to_string(values.size()); }
+	void mutate() {
+		if (!values.empty()) values[0] += 1.0;
+	}
+	BigDNA crossover(const BigDNA &other) { return other; }
+	void reset() {}
+};
+
+struct BenchGA : public GAGA::GA<BigDNA> {
+	BenchGA() : GAGA::GA<BigDNA>(0, nullptr) {}
+	void useCopies() {
+		nextGeneration = [this]() {
+			evaluate();
+			auto nextGen = produceNOffsprings(popSize, population, nbElites);
+			lastGen = population;
+			population = nextGen;
+		};
+	}
+};
+
+static void run(const std::string &name, bool copies, size_t popSize, size_t dnaSize,
+                size_t nbGenerations) {
+	BenchGA ga;
+	ga.setVerbosity(0);
+	ga.disablePopulationSave();
+	ga.setSaveGenStats(false);
+	ga.setSaveFolder("/tmp/gaga_bench");
+	if (copies) ga.useCopies();
+	ga.setCrossoverProba(0.0);  // crossovers would allocate in both versions
+	ga.setMutationProba(0.8);
+	ga.setEvaluator([](auto &i) { i.fitnesses["obj0"] = i.dna.values[0]; });
+	ga.setPopSize(popSize);
+	ga.initPopulation([&]() { return BigDNA(dnaSize); });
+	ga.step(2);  // the buffers are in place
+	size_t bytes0 = allocatedBytes;
+	auto t0 = std::chrono::high_resolution_clock::now();
+	ga.step(static_cast<int>(nbGenerations));
+	auto t1 = std::chrono::high_resolution_clock::now();
+	double mb = static_cast<double>(allocatedBytes - bytes0) / (1024.0 * 1024.0);
+	double t = std::chrono::duration<double>(t1 - t0).count();
+	std::cout << name << ": " << mb / static_cast<double>(nbGenerations)
+	          << " MB allocated per generation, "
+	          << 1000.0 * t / static_cast<double>(nbGenerations) << " ms per generation"
+	          << std::endl;
+}
+
+int main(int argc, char **argv) {
+	size_t popSize = argc > 1 ? std::stoul(argv[1]) : 50;
+	size_t dnaSize = argc > 2 ? std::stoul(argv[2]) : 1 << 19;  // 4 MB
+	size_t nbGenerations = argc > 3 ? std::stoul(argv[3]) : 10;
+	std::cout << "popSize = " << popSize << ", DNA = "
+	          << static_cast<double>(dnaSize * sizeof(double)) / (1024.0 * 1024.0) << " MB"
+	          << std::endl;
+	run("copy", true, popSize, dnaSize, nbGenerations);
+	run("swap", false, popSize, dnaSize, nbGenerations);
+	return 0;
+}
@@ -0,0 +1,70 @@
+// Novelty archive search: brute force versus the KD-tree index, in exact mode and in
+// approximate mode with several leaf check budgets (recall = fraction of the true k
+// nearest neighbours found).
+// usage: kdtree [maxArchiveSize] [nbSnapshots] [snapshotSize] [K]
+#include <iostream>
+#include "../gaga.hpp"
+
+template <typename F> double timeIt(F &&f) {
+	auto t0 = std::chrono::high_resolution_clock::now();
+	f();
+	auto t1 = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration<double>(t1 - t0).count();
+}
+
+int main(int argc, char **argv) {
+	size_t maxArchiveSize = argc > 1 ? std::stoul(argv[1]) : 1000000;
+	size_t nbSnapshots = argc > 2 ? std::stoul(argv[2]) : 2;
+	size_t snapshotSize = argc > 3 ? std::stoul(argv[3]) : 4;
+	size_t K = argc > 4 ? std::stoul(argv[4]) : 15;
+	std::default_random_engine rnd(0);
+	std::uniform_real_distribution<double> d(-1.0, 1.0);
+	auto randomFootprint = [&]() {
+		GAGA::fpType f(nbSnapshots, std::vector<double>(snapshotSize));
+		for (auto &s : f)
+			for (auto &x : s) x = d(rnd);
+		return GAGA::FlatFootprint(f);
+	};
+	const size_t nbQueries = 200;
+	std::vector<GAGA::FlatFootprint> queries;
+	for (size_t i = 0; i < nbQueries; ++i) queries.push_back(randomFootprint());
+	const std::vector<size_t> leafChecks = {0, 32, 8, 1};
+
+	std::cout << "footprint = " << nbSnapshots << "x" << snapshotSize << ", K = " << K
+	          << " (times in us/query)" << std::endl;
+	std::cout << "archive\tinsert (us)\tbrute";
+	for (auto c : leafChecks)
+		std::cout << "\t" << (c ? "checks=" + std::to_string(c) : "exact") << "\trecall";
+	std::cout << std::endl;
+
+	std::vector<GAGA::FlatFootprint> archive;
+	GAGA::FootprintKDTree index;
+	double insertTime = 0;
+	for (size_t archiveSize = 10000; archiveSize <= maxArchiveSize; archiveSize *= 10) {
+		size_t inserted = archive.size();
+		while (archive.size() < archiveSize) archive.push_back(randomFootprint());
+		insertTime += timeIt([&]() {
+			for (size_t i = inserted; i < archive.size(); ++i) index.insert(archive[i]);
+		});
+		std::vector<GAGA::KNNHeap> truth(nbQueries, GAGA::KNNHeap(K));
+		double bruteTime = timeIt([&]() {
+			for (size_t q = 0; q < nbQueries; ++q)
+				for (const auto &a : archive) truth[q].push(GAGA::squaredDistance(queries[q], a));
+		});
+		std::cout << archiveSize << "\t" << insertTime / static_cast<double>(archiveSize) * 1e6
+		          << "\t" << bruteTime / nbQueries * 1e6;
+		for (auto c : leafChecks) {
+			std::vector<GAGA::KNNHeap> found(nbQueries, GAGA::KNNHeap(K));
+			double t = timeIt([&]() {
+				for (size_t q = 0; q < nbQueries; ++q) index.knn(queries[q], found[q], c);
+			});
+			size_t hits = 0;
+			for (size_t q = 0; q < nbQueries; ++q)
+				for (auto dist : found[q].heap) hits += dist <= truth[q].worst();
+			std::cout << "\t" << t / nbQueries * 1e6 << "\t"
+			          << static_cast<double>(hits) / static_cast<double>(nbQueries * K);
+		}
+		std::cout << std::endl;
+	}
+	return 0;
+}
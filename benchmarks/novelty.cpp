@@ -0,0 +1,114 @@
+// Per-individual novelty cost (k-nearest neighbours average distance) versus archive
+// size. "copy" is the former computeAvgDist, which copied whole individuals into its
+// k-NN set; "heap" is GA::computeNovelty, which updateNovelty calls for each individual
+// and which only keeps distances in a bounded heap (archive scanned, no index).
+// usage: novelty [dnaSize] [K]
+#include <iostream>
+#include "../gaga.hpp"
+
+struct VecDNA {
+	std::vector<double> values;
+	VecDNA() {}
+	explicit VecDNA(const std::string &js) {
+		auto o = nlohmann::json::parse(js);
+		values = o.at("values").get<std::vector<double>>();
+	}
+	std::string serialize() const {
+		nlohmann::json o;
+		o["values"] = values;
+		return o.dump();
+	}
+	void mutate() {}
+	VecDNA crossover(const VecDNA &other) { return other; }
+	void reset() {}
+};
+
+using Ind = GAGA::Individual<VecDNA>;
+
+// exposes the protected novelty routines
+struct BenchGA : public GAGA::GA<VecDNA> {
+	BenchGA() : GAGA::GA<VecDNA>(0, nullptr) {}
+	using GAGA::GA<VecDNA>::computeNovelty;
+	using GAGA::GA<VecDNA>::getFootprintDistance;
+	// the population stays empty, so that novelties only depend on the archive
+	void addToArchive(const Ind &ind) { archive.emplace_back(ind, false); }
+};
+
+static double copyAvgDist(size_t K, const std::vector<Ind> &arch, const GAGA::fpType &fp) {
+	double avgDist = 0;
+	if (arch.size() > 1) {
+		size_t k = arch.size() < K ? arch.size() : K;
+		std::vector<Ind> knn;
+		std::vector<double> knnDist;
+		std::pair<double, size_t> worstKnn = {0, 0};
+		for (size_t i = 0; i < k; ++i) {
+			knn.push_back(arch[i]);
+			knnDist.push_back(BenchGA::getFootprintDistance(fp, arch[i].footprint));
+			if (knnDist.back() > worstKnn.first) worstKnn = {knnDist.back(), i};
+		}
+		for (size_t i = k; i < arch.size(); ++i) {
+			double d = BenchGA::getFootprintDistance(fp, arch[i].footprint);
+			if (d < worstKnn.first) {
+				knn[worstKnn.second] = arch[i];
+				knnDist[worstKnn.second] = d;
+				worstKnn.first = d;
+				for (size_t j = 0; j < knn.size(); ++j)
+					if (knnDist[j] > worstKnn.first) worstKnn = {knnDist[j], j};
+			}
+		}
+		for (auto d : knnDist) avgDist += d;
+		avgDist /= static_cast<double>(k);
+	}
+	return avgDist;
+}
+
+template <typename F> double timeIt(F &&f) {
+	auto t0 = std::chrono::high_resolution_clock::now();
+	f();
+	auto t1 = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration<double>(t1 - t0).count();
+}
+
+int main(int argc, char **argv) {
+	size_t dnaSize = argc > 1 ? std::stoul(argv[1]) : 1000;
+	size_t K = argc > 2 ? std::stoul(argv[2]) : 15;
+	std::default_random_engine rnd(0);
+	std::uniform_real_distribution<double> d(-1.0, 1.0);
+	auto randomInd = [&]() {
+		VecDNA dna;
+		dna.values.resize(dnaSize);
+		Ind ind(dna);
+		ind.fitnesses["obj0"] = d(rnd);
+		ind.footprint = {{d(rnd), d(rnd), d(rnd), d(rnd)}, {d(rnd), d(rnd), d(rnd), d(rnd)}};
+		ind.flattenFootprint();
+		return ind;
+	};
+	const size_t nbQueries = 100;
+	std::vector<Ind> queries;
+	for (size_t i = 0; i < nbQueries; ++i) queries.push_back(randomInd());
+
+	BenchGA ga;
+	ga.setVerbosity(0);
+	ga.setKNN(K);
+	std::cout << "dnaSize = " << dnaSize << " doubles, K = " << K << std::endl;
+	std::cout << "archive\tcopy (us/ind)\theap (us/ind)" << std::endl;
+	std::vector<Ind> archive;
+	for (size_t archiveSize = 1000; archiveSize <= 100000; archiveSize *= 10) {
+		while (archive.size() < archiveSize) {
+			archive.push_back(randomInd());
+			ga.addToArchive(archive.back());
+		}
+		double copySum = 0, heapSum = 0;
+		double copyTime = timeIt([&]() {
+			for (const auto &q : queries) copySum += copyAvgDist(K, archive, q.footprint);
+		});
+		double heapTime = timeIt([&]() {
+			for (const auto &q : queries) heapSum += ga.computeNovelty(q.flatFootprint);
+		});
+		if (std::abs(copySum - heapSum) > 1e-6 * copySum)
+			std::cerr << "results differ: " << copySum << " vs " << heapSum << std::endl;
+		std::cout << archiveSize << "\t" << copyTime / nbQueries * 1e6 << "\t"
+		          << heapTime / nbQueries * 1e6 << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,78 @@
+// Time per generation with a cheap evaluator, where selection and comparisons dominate:
+// "dynamic" is GA<DNA> (selection method and comparison chosen at runtime, comparisons
+// through a std::function), "fixed" is GA<DNA, Maximize, XSelection>, where both are
+// template policies that the compiler can inline.
+// usage: selection [popSize] [nbGenerations] [tournamentSize]
+#include <iostream>
+#include "../gaga.hpp"
+
+struct TinyDNA {
+	std::vector<double> values;
+	std::default_random_engine rnd;
+	TinyDNA() : values(4, 0.0) {}
+	explicit TinyDNA(const std::string &) : values(4, 0.0) {}
+	std::string serialize() const { return ""; }
+	void mutate() {
+		std::uniform_real_distribution<double> d(-0.1, 0.1);
+		for (auto &v : values) v += d(rnd);
+	}
+	TinyDNA crossover(const TinyDNA &other) {
+		TinyDNA res = *this;
+		for (size_t i = 0; i < values.size(); i += 2) res.values[i] = other.values[i];
+		return res;
+	}
+	void reset() {}
+};
+
+template <typename G>
+double run(G &ga, size_t popSize, size_t nbGenerations, size_t tournamentSize) {
+	ga.setVerbosity(0);
+	ga.disablePopulationSave();
+	ga.setSaveGenStats(false);
+	ga.setNbSavedElites(0);
+	ga.setSaveFolder("/tmp/gaga_bench");
+	ga.setSeed(0);
+	ga.setTournamentSize(tournamentSize);
+	ga.setEvaluator([](auto &i) {
+		i.fitnesses["obj0"] = i.dna.values[0] + i.dna.values[1];
+		i.fitnesses["obj1"] = i.dna.values[2] - i.dna.values[3];
+	});
+	ga.setPopSize(popSize);
+	ga.initPopulation([]() { return TinyDNA(); });
+	ga.step(1);
+	auto t0 = std::chrono::high_resolution_clock::now();
+	ga.step(static_cast<int>(nbGenerations));
+	auto t1 = std::chrono::high_resolution_clock::now();
+	return 1000.0 * std::chrono::duration<double>(t1 - t0).count() /
+	       static_cast<double>(nbGenerations);
+}
+
+template <typename FixedSelection>
+void compare(const std::string &name, GAGA::SelectionMethod method, size_t popSize,
+             size_t nbGenerations, size_t tournamentSize) {
+	GAGA::GA<TinyDNA> dynamic(0, nullptr);
+	dynamic.setSelectionMethod(method);
+	GAGA::GA<TinyDNA, GAGA::Maximize, FixedSelection> fixed(0, nullptr);
+	double tDynamic = run(dynamic, popSize, nbGenerations, tournamentSize);
+	double tFixed = run(fixed, popSize, nbGenerations, tournamentSize);
+	std::cout << name << ": dynamic " << tDynamic << " ms, fixed " << tFixed
+	          << " ms per generation (x" << tDynamic / tFixed << ")" << std::endl;
+}
+
+int main(int argc, char **argv) {
+	size_t popSize = argc > 1 ? std::stoul(argv[1]) : 5000;
+	size_t nbGenerations = argc > 2 ? std::stoul(argv[2]) : 20;
+	size_t tournamentSize = argc > 3 ? std::stoul(argv[3]) : 8;
+	std::cout << "popSize = " << popSize << ", tournamentSize = " << tournamentSize
+	          << std::endl;
+	compare<GAGA::ParetoTournamentSelection>("paretoTournament",
+	                                         GAGA::SelectionMethod::paretoTournament, popSize,
+	                                         nbGenerations, tournamentSize);
+	compare<GAGA::RandomObjTournamentSelection>("randomObjTournament",
+	                                            GAGA::SelectionMethod::randomObjTournament,
+	                                            popSize, nbGenerations, tournamentSize);
+	compare<GAGA::NSGA2TournamentSelection>("nsga2Tournament",
+	                                        GAGA::SelectionMethod::nsga2Tournament, popSize,
+	                                        nbGenerations, tournamentSize);
+	return 0;
+}
@@ -0,0 +1,116 @@
+// Compares the json and binary encodings of the MPI messages of one generation: tasks
+// (population indices and dna of the individuals to evaluate) sent to the workers, and
+// results (the same indices and the evaluation results) sent back to the master. Reports
+// the bytes sent and the time spent packing and unpacking these messages.
+// usage: serialization [popSize] [dnaSize]
+#include <iostream>
+#include "../gaga.hpp"
+
+struct VecDNA {
+	std::vector<double> values;
+	VecDNA() {}
+	explicit VecDNA(const std::string &js) {
+		auto o = nlohmann::json::parse(js);
+		values = o.at("values").get<std::vector<double>>();
+	}
+	std::string serialize() const {
+		nlohmann::json o;
+		o["values"] = values;
+		return o.dump();
+	}
+	void serializeBinary(std::vector<char> &buffer) const {
+		const char *p = reinterpret_cast<const char *>(values.data());
+		buffer.insert(buffer.end(), p, p + values.size() * sizeof(double));
+	}
+	static VecDNA deserializeBinary(const char *data, size_t size) {
+		VecDNA d;
+		d.values.resize(size / sizeof(double));
+		std::memcpy(d.values.data(), data, size);
+		return d;
+	}
+	void mutate() {}
+	VecDNA crossover(const VecDNA &other) { return other; }
+	void reset() {}
+};
+
+using Ind = GAGA::Individual<VecDNA>;
+
+template <typename F> double timeIt(F &&f) {
+	auto t0 = std::chrono::high_resolution_clock::now();
+	f();
+	auto t1 = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration<double>(t1 - t0).count();
+}
+
+struct Transfer {
+	size_t bytes = 0;
+	double time = 0.0;
+};
+
+// evaluated: what the workers compute for each individual
+Transfer generation(bool binary, const std::vector<Ind> &evaluated) {
+	GAGA::GA<VecDNA> ga(0, nullptr);
+	if (binary)
+		ga.enableBinaryTransfer();
+	else
+		ga.disableBinaryTransfer();
+	std::vector<Ind> pop;  // master side, waiting for its evaluations
+	for (const auto &i : evaluated) pop.emplace_back(i.dna);
+	std::vector<size_t> pending(pop.size());
+	std::iota(pending.begin(), pending.end(), 0);
+
+	Transfer t;
+	std::vector<char> tasks, results;
+	std::vector<size_t> indices;
+	std::vector<Ind> received;
+	t.time += timeIt([&]() {
+		tasks = ga.MPI_packTasks(pop, pending);
+		received = ga.MPI_unpackTasks(tasks, indices);
+	});
+	for (size_t k = 0; k < received.size(); ++k) {  // the evaluation itself
+		const auto &e = evaluated[indices[k]];
+		received[k].fitnesses = e.fitnesses;
+		received[k].footprint = e.footprint;
+		received[k].evaluated = true;
+	}
+	t.time += timeIt([&]() {
+		results = ga.MPI_packResults(indices, received);
+		ga.MPI_unpackResults(pop, results);
+	});
+	t.bytes = tasks.size() + results.size();
+	for (size_t i = 0; i < pop.size(); ++i) {
+		if (pop[i].dna.values.size() != evaluated[i].dna.values.size() ||
+		    pop[i].fitnesses.size() != evaluated[i].fitnesses.size()) {  // (json rounds doubles)
+			std::cerr << (binary ? "binary" : "json") << " round trip failed" << std::endl;
+			break;
+		}
+	}
+	return t;
+}
+
+int main(int argc, char **argv) {
+	size_t popSize = argc > 1 ? std::stoul(argv[1]) : 500;
+	size_t dnaSize = argc > 2 ? std::stoul(argv[2]) : 10000;
+	std::default_random_engine rnd(0);
+	std::uniform_real_distribution<double> d(-1.0, 1.0);
+	std::vector<Ind> evaluated;
+	for (size_t i = 0; i < popSize; ++i) {
+		VecDNA dna;
+		for (size_t j = 0; j < dnaSize; ++j) dna.values.push_back(d(rnd));
+		Ind ind(dna);
+		ind.fitnesses["obj0"] = d(rnd);
+		ind.fitnesses["obj1"] = d(rnd);
+		ind.footprint = {{d(rnd), d(rnd), d(rnd)}, {d(rnd), d(rnd), d(rnd)}};
+		evaluated.push_back(ind);
+	}
+
+	Transfer json = generation(false, evaluated);
+	Transfer binary = generation(true, evaluated);
+	std::cout << "popSize = " << popSize << ", dnaSize = " << dnaSize << " doubles" << std::endl;
+	std::cout << "json   : " << json.bytes << " bytes/gen, " << json.time << " s/gen" << std::endl;
+	std::cout << "binary : " << binary.bytes << " bytes/gen, " << binary.time << " s/gen"
+	          << std::endl;
+	std::cout << "ratio  : x" << static_cast<double>(json.bytes) / binary.bytes << " bytes, x"
+	          << json.time / binary.time << " time" << std::endl;
+	return 0;
+}
@@ -31,20 +31,42 @@
 #ifdef OMP
 #include <omp.h>
 #endif
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 #include <assert.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
 #include <algorithm>
+#include <cerrno>
 #include <chrono>
-#include <cstring>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <deque>
 #include <fstream>
+#include <functional>
+#include <limits>
+#include <list>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <queue>
 #include <random>
+#include <shared_mutex>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -96,6 +118,420 @@ using std::chrono::system_clock;
 // #define OMP if you want OpenMP parallelisation
 // #define CLUSTER if you want MPI parallelisation
 
+/*****************************************************************************
+ *                         BINARY SERIALIZATION
+ * **************************************************************************/
+// Compact length-prefixed binary encoding of individuals, used as a faster
+// alternative to json for MPI transfers.
+// A DNA class can opt in to a raw binary representation by providing:
+// void serializeBinary(std::vector<char>& buffer) const (appends its bytes to buffer)
+// static DNA deserializeBinary(const char* data, size_t size)
+// Otherwise, the output of serialize() is stored as a length-prefixed string.
+
+template <typename... T> struct makeVoid { using type = void; };
+
+template <typename T, typename = void> struct hasBinarySerialization : std::false_type {};
+template <typename T>
+struct hasBinarySerialization<
+    T, typename makeVoid<decltype(std::declval<const T &>().serializeBinary(
+                             std::declval<vector<char> &>())),
+                         decltype(T::deserializeBinary(std::declval<const char *>(),
+                                                       std::declval<size_t>()))>::type>
+    : std::true_type {};
+
+struct BinaryWriter {
+	vector<char> &buffer;
+	explicit BinaryWriter(vector<char> &b) : buffer(b) {}
+
+	template <typename T> void write(const T &v) {
+		static_assert(std::is_trivially_copyable<T>::value, "Only raw values can be written");
+		const char *p = reinterpret_cast<const char *>(&v);
+		buffer.insert(buffer.end(), p, p + sizeof(T));
+	}
+	void writeBytes(const char *p, size_t n) {
+		write<uint64_t>(n);
+		buffer.insert(buffer.end(), p, p + n);
+	}
+	void writeString(const string &s) { writeBytes(s.data(), s.size()); }
+	void writeMap(const map<string, double> &m) {
+		write<uint64_t>(m.size());
+		for (const auto &e : m) {
+			writeString(e.first);
+			write(e.second);
+		}
+	}
+	void writeFootprint(const fpType &f) {
+		write<uint64_t>(f.size());
+		for (const auto &snapshot : f)
+			writeBytes(reinterpret_cast<const char *>(snapshot.data()),
+			           snapshot.size() * sizeof(double));
+	}
+	// reserves room for a length prefix, to be filled later with endLengthPrefix
+	size_t beginLengthPrefix() {
+		write<uint64_t>(0);
+		return buffer.size();
+	}
+	void endLengthPrefix(size_t start) {
+		uint64_t n = buffer.size() - start;
+		std::memcpy(buffer.data() + start - sizeof(uint64_t), &n, sizeof(uint64_t));
+	}
+};
+
+struct BinaryReader {
+	const char *cur;
+	const char *end;
+	BinaryReader(const char *data, size_t size) : cur(data), end(data + size) {}
+
+	const char *skip(size_t n) {
+		if (static_cast<size_t>(end - cur) < n)
+			throw std::runtime_error("Truncated binary buffer");
+		const char *p = cur;
+		cur += n;
+		return p;
+	}
+	template <typename T> T read() {
+		static_assert(std::is_trivially_copyable<T>::value, "Only raw values can be read");
+		T v;
+		std::memcpy(&v, skip(sizeof(T)), sizeof(T));
+		return v;
+	}
+	// returns a pointer to the n bytes following the length prefix
+	const char *readBytes(size_t &n) {
+		n = static_cast<size_t>(read<uint64_t>());
+		return skip(n);
+	}
+	string readString() {
+		size_t n;
+		const char *p = readBytes(n);
+		return string(p, n);
+	}
+	map<string, double> readMap() {
+		map<string, double> m;
+		auto n = read<uint64_t>();
+		for (uint64_t i = 0; i < n; ++i) {
+			auto k = readString();
+			m[k] = read<double>();
+		}
+		return m;
+	}
+	fpType readFootprint() {
+		fpType f(static_cast<size_t>(read<uint64_t>()));
+		for (auto &snapshot : f) {
+			size_t n;
+			const char *p = readBytes(n);
+			snapshot.resize(n / sizeof(double));
+			std::memcpy(snapshot.data(), p, n);
+		}
+		return f;
+	}
+	bool done() const { return cur == end; }
+};
+
+template <typename DNA>
+typename std::enable_if<hasBinarySerialization<DNA>::value>::type writeDNA(BinaryWriter &w,
+                                                                           const DNA &d) {
+	auto start = w.beginLengthPrefix();
+	d.serializeBinary(w.buffer);
+	w.endLengthPrefix(start);
+}
+template <typename DNA>
+typename std::enable_if<!hasBinarySerialization<DNA>::value>::type writeDNA(
+    BinaryWriter &w, const DNA &d) {
+	w.writeString(d.serialize());
+}
+template <typename DNA>
+typename std::enable_if<hasBinarySerialization<DNA>::value, DNA>::type readDNA(
+    BinaryReader &r) {
+	size_t n;
+	const char *p = r.readBytes(n);
+	return DNA::deserializeBinary(p, n);
+}
+template <typename DNA>
+typename std::enable_if<!hasBinarySerialization<DNA>::value, DNA>::type readDNA(
+    BinaryReader &r) {
+	return DNA(r.readString());
+}
+
+/*****************************************************************************
+ *                         FLAT FOOTPRINTS
+ * **************************************************************************/
+// Evaluators fill footprints as a vector of snapshots (fpType). Before novelty is
+// computed, they are copied into a single aligned buffer whose shape is recorded, so
+// that distances are computed by a vectorized kernel over contiguous memory.
+
+template <typename T, size_t Alignment = 64> struct AlignedAllocator {
+	using value_type = T;
+	template <typename U> struct rebind { using other = AlignedAllocator<U, Alignment>; };
+	AlignedAllocator() = default;
+	template <typename U> AlignedAllocator(const AlignedAllocator<U, Alignment> &) {}
+	T *allocate(size_t n) {
+		void *p = nullptr;
+		if (posix_memalign(&p, Alignment, n * sizeof(T)) != 0) throw std::bad_alloc();
+		return static_cast<T *>(p);
+	}
+	void deallocate(T *p, size_t) { free(p); }
+	template <typename U> bool operator==(const AlignedAllocator<U, Alignment> &) const {
+		return true;
+	}
+	template <typename U> bool operator!=(const AlignedAllocator<U, Alignment> &) const {
+		return false;
+	}
+};
+
+// sum of (a[i] - b[i])^2 for i in [0, n)
+inline double squaredDistance(const double *a, const double *b, size_t n) {
+	size_t i = 0;
+	double d = 0;
+#if defined(__AVX512F__)
+	__m512d acc = _mm512_setzero_pd();
+	for (; i + 8 <= n; i += 8) {
+		__m512d diff = _mm512_sub_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i));
+		acc = _mm512_fmadd_pd(diff, diff, acc);
+	}
+	alignas(64) double lanes[8];
+	_mm512_store_pd(lanes, acc);
+	d = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) +
+	    ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+#elif defined(__AVX2__)
+	__m256d acc0 = _mm256_setzero_pd();
+	__m256d acc1 = _mm256_setzero_pd();
+	for (; i + 8 <= n; i += 8) {
+		__m256d d0 = _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i));
+		__m256d d1 = _mm256_sub_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4));
+#ifdef __FMA__
+		acc0 = _mm256_fmadd_pd(d0, d0, acc0);
+		acc1 = _mm256_fmadd_pd(d1, d1, acc1);
+#else
+		acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(d0, d0));
+		acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(d1, d1));
+#endif
+	}
+	alignas(32) double lanes[4];
+	_mm256_store_pd(lanes, _mm256_add_pd(acc0, acc1));
+	d = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#else
+	// independent accumulators let the compiler vectorize without -ffast-math
+	double acc[4] = {0, 0, 0, 0};
+	for (; i + 4 <= n; i += 4) {
+		for (size_t j = 0; j < 4; ++j) {
+			double diff = a[i + j] - b[i + j];
+			acc[j] += diff * diff;
+		}
+	}
+	d = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+#endif
+	for (; i < n; ++i) {
+		double diff = a[i] - b[i];
+		d += diff * diff;
+	}
+	return d;
+}
+
+struct FlatFootprint {
+	vector<double, AlignedAllocator<double>> data;  // snapshots, one after the other
+	size_t nbSnapshots = 0;
+	size_t snapshotSize = 0;
+
+	FlatFootprint() {}
+	explicit FlatFootprint(const fpType &f) { assign(f); }
+
+	void assign(const fpType &f) {
+		nbSnapshots = f.size();
+		snapshotSize = f.empty() ? 0 : f[0].size();
+		data.clear();
+		data.reserve(nbSnapshots * snapshotSize);
+		for (const auto &snapshot : f) {
+			assert(snapshot.size() == snapshotSize);
+			data.insert(data.end(), snapshot.begin(), snapshot.end());
+		}
+	}
+	bool sameShape(const FlatFootprint &o) const {
+		return nbSnapshots == o.nbSnapshots && snapshotSize == o.snapshotSize;
+	}
+	size_t size() const { return data.size(); }
+	bool empty() const { return data.empty(); }
+	fpType toFpType() const {
+		fpType f(nbSnapshots);
+		for (size_t i = 0; i < nbSnapshots; ++i)
+			f[i].assign(data.begin() + static_cast<long>(i * snapshotSize),
+			            data.begin() + static_cast<long>((i + 1) * snapshotSize));
+		return f;
+	}
+};
+
+inline double squaredDistance(const FlatFootprint &f0, const FlatFootprint &f1) {
+	assert(f0.sameShape(f1));
+	return squaredDistance(f0.data.data(), f1.data.data(), f0.size());
+}
+
+// Keeps the k smallest squared distances seen so far in a bounded max-heap
+// (k-nearest neighbours search without copying the neighbours themselves)
+struct KNNHeap {
+	size_t k;
+	vector<double> heap;
+	explicit KNNHeap(size_t n) : k(n) { heap.reserve(n); }
+	bool full() const { return heap.size() == k; }
+	// squared distance of the current k-th neighbour (the bound to beat)
+	double worst() const {
+		return full() ? heap.front() : std::numeric_limits<double>::max();
+	}
+	void push(double sqDist) {
+		if (heap.size() < k) {
+			heap.push_back(sqDist);
+			std::push_heap(heap.begin(), heap.end());
+		} else if (sqDist < heap.front()) {
+			std::pop_heap(heap.begin(), heap.end());
+			heap.back() = sqDist;
+			std::push_heap(heap.begin(), heap.end());
+		}
+	}
+	double avgDist() const {
+		if (heap.empty()) return 0;
+		double sum = 0;
+		for (auto d : heap) sum += sqrt(d);
+		return sum / static_cast<double>(heap.size());
+	}
+};
+
+// KD-tree over flat footprints, used to index the novelty archive.
+// Points are inserted one by one (leaves are split at the midpoint of their widest
+// dimension when they grow over leafSize) and copied in a contiguous buffer.
+// Queries are best-first: leaves are visited by increasing lower bound on their
+// distance to the query. An exact query stops when no leaf can hold a closer point; an
+// approximate one stops after maxLeafChecks leaves (higher = better recall).
+// Removed points are only taken out of their leaf: the tree keeps its shape and their
+// coordinates stay in the buffer until the next clear (see nbRemoved).
+class FootprintKDTree {
+ public:
+	explicit FootprintKDTree(size_t lSize = 32) : leafSize(lSize) {}
+
+	size_t size() const { return nbPoints - removedPoints; }  // live points
+	size_t nbRemoved() const { return removedPoints; }
+	size_t dim() const { return dimension; }
+	void clear() {
+		nodes.clear();
+		points.clear();
+		nbPoints = 0;
+		removedPoints = 0;
+		dimension = 0;
+	}
+
+	// returns the id of the new point (ids are given in insertion order, from 0)
+	size_t insert(const FlatFootprint &f) {
+		if (nbPoints == 0) {
+			dimension = f.size();
+			nodes.assign(1, Node());
+			nodes[0].splitAt = leafSize;
+		}
+		if (f.size() != dimension)
+			throw std::invalid_argument("All footprints of the archive must have the same size");
+		points.insert(points.end(), f.data.begin(), f.data.end());
+		size_t n = 0;
+		while (!nodes[n].isLeaf())
+			n = f.data[nodes[n].splitDim] < nodes[n].splitValue ? nodes[n].left : nodes[n].right;
+		nodes[n].points.push_back(nbPoints);
+		if (nodes[n].points.size() > nodes[n].splitAt) split(n);
+		return nbPoints++;
+	}
+
+	// removes a point given its id (the leaf is found from its coordinates, the same way
+	// it was inserted)
+	void remove(size_t id) {
+		assert(id < nbPoints);
+		const double *p = &points[id * dimension];
+		size_t n = 0;
+		while (!nodes[n].isLeaf())
+			n = p[nodes[n].splitDim] < nodes[n].splitValue ? nodes[n].left : nodes[n].right;
+		auto &leaf = nodes[n].points;
+		auto it = std::find(leaf.begin(), leaf.end(), id);
+		assert(it != leaf.end());
+		leaf.erase(it);
+		++removedPoints;
+	}
+
+	// pushes the squared distances of the nearest points to q in knn
+	void knn(const FlatFootprint &q, KNNHeap &heap, size_t maxLeafChecks = 0) const {
+		if (size() == 0) return;
+		assert(q.size() == dimension);
+		using Candidate = std::pair<double, size_t>;  // {lower bound, node}
+		std::priority_queue<Candidate, vector<Candidate>, std::greater<Candidate>> toVisit;
+		toVisit.push({0.0, 0});
+		size_t leafChecks = 0;
+		while (!toVisit.empty()) {
+			auto c = toVisit.top();
+			toVisit.pop();
+			if (heap.full() && (c.first >= heap.worst() ||
+			                    (maxLeafChecks > 0 && leafChecks >= maxLeafChecks)))
+				break;
+			size_t n = c.second;
+			while (!nodes[n].isLeaf()) {
+				const Node &node = nodes[n];
+				double diff = q.data[node.splitDim] - node.splitValue;
+				size_t nearChild = diff < 0 ? node.left : node.right;
+				size_t farChild = diff < 0 ? node.right : node.left;
+				toVisit.push({std::max(c.first, diff * diff), farChild});
+				n = nearChild;
+			}
+			for (auto p : nodes[n].points)
+				heap.push(squaredDistance(q.data.data(), &points[p * dimension], dimension));
+			++leafChecks;
+		}
+	}
+
+ protected:
+	struct Node {
+		size_t splitDim = 0;
+		double splitValue = 0;
+		size_t left = 0, right = 0;  // children (the root can't be a child: 0 = leaf)
+		size_t splitAt = 0;          // nb of points above which a leaf is split
+		vector<size_t> points;       // leaves only
+		bool isLeaf() const { return left == 0; }
+	};
+	vector<Node> nodes;
+	vector<double, AlignedAllocator<double>> points;
+	size_t nbPoints = 0;  // removed ones included
+	size_t removedPoints = 0;
+	size_t dimension = 0;
+	size_t leafSize;
+
+	void split(size_t n) {
+		// widest dimension of the leaf
+		size_t bestDim = 0;
+		double bestSpread = 0, bestMin = 0, bestMax = 0;
+		for (size_t d = 0; d < dimension; ++d) {
+			double lo = std::numeric_limits<double>::max();
+			double hi = std::numeric_limits<double>::lowest();
+			for (auto p : nodes[n].points) {
+				lo = std::min(lo, points[p * dimension + d]);
+				hi = std::max(hi, points[p * dimension + d]);
+			}
+			if (hi - lo > bestSpread) {
+				bestSpread = hi - lo;
+				bestDim = d;
+				bestMin = lo;
+				bestMax = hi;
+			}
+		}
+		if (bestSpread == 0) {  // identical points: wait until the leaf doubles
+			nodes[n].splitAt *= 2;
+			return;
+		}
+		Node l, r;
+		l.splitAt = r.splitAt = leafSize;
+		double splitValue = bestMin + (bestMax - bestMin) * 0.5;
+		for (auto p : nodes[n].points)
+			(points[p * dimension + bestDim] < splitValue ? l : r).points.push_back(p);
+		Node &node = nodes[n];
+		node.splitDim = bestDim;
+		node.splitValue = splitValue;
+		node.points = vector<size_t>();
+		node.left = nodes.size();
+		node.right = nodes.size() + 1;
+		nodes.push_back(std::move(l));
+		nodes.push_back(std::move(r));
+	}
+};
+
 /*****************************************************************************
  *                         INDIVIDUAL CLASS
  * **************************************************************************/
@@ -110,25 +546,61 @@ using std::chrono::system_clock;
 template <typename DNA> struct Individual {
 	DNA dna;
 	map<string, double> fitnesses;  // map {"fitnessCriterName" -> "fitnessValue"}
+	vector<double> objectives;      // dense copy of fitnesses, indexed by GA::objectiveNames
 	fpType footprint;               // individual's footprint for novelty computation
+	FlatFootprint flatFootprint;    // contiguous copy of footprint (see flattenFootprint)
 	string infos;                   // custom infos, description, whatever...
 	bool evaluated = false;
 	bool wasAlreadyEvaluated = false;
 	double evalTime = 0.0;
+	// NSGA-II selection: index of the individual's pareto front and crowding distance
+	// within this front (see GA::computeNSGA2Ranks)
+	size_t paretoRank = 0;
+	double crowdingDistance = 0.0;
 	map<string, double> stats;  // custom stats
 
 	Individual() {}
 	explicit Individual(const DNA &d) : dna(d) {}
 
+	// refreshes flatFootprint from the footprint set by the evaluator
+	void flattenFootprint() { flatFootprint.assign(footprint); }
+
+	// turns an individual of an old generation into a new, unevaluated one. DNAs are
+	// copy assigned, so that they can reuse the memory they already hold.
+	void recycle(const DNA &d) {
+		dna = d;
+		clearResults();
+	}
+	void recycle(DNA &&d) {
+		dna = std::move(d);
+		clearResults();
+	}
+	void clearResults() {
+		fitnesses.clear();
+		objectives.clear();
+		footprint.clear();
+		flatFootprint.assign({});
+		infos.clear();
+		stats.clear();
+		evaluated = false;
+		wasAlreadyEvaluated = false;
+		evalTime = 0.0;
+		paretoRank = 0;
+		crowdingDistance = 0.0;
+	}
+
 	explicit Individual(const json &o) {
 		assert(o.count("dna"));
-		dna = DNA(o.at("dna").dump());
+		// dna is either the raw output of serialize() or an embedded json object
+		dna = o.at("dna").is_string() ? DNA(o.at("dna").get<string>()) : DNA(o.at("dna").dump());
 		if (o.count("footprint")) footprint = o.at("footprint").get<fpType>();
+		flattenFootprint();
 		if (o.count("fitnesses")) fitnesses = o.at("fitnesses").get<decltype(fitnesses)>();
 		if (o.count("infos")) infos = o.at("infos");
 		if (o.count("evaluated")) evaluated = o.at("evaluated");
 		if (o.count("alreadyEval")) wasAlreadyEvaluated = o.at("alreadyEval");
 		if (o.count("evalTime")) evalTime = o.at("evalTime");
+		if (o.count("stats")) stats = o.at("stats").get<decltype(stats)>();
 	}
 
 	// Exports individual to json
@@ -141,6 +613,7 @@ template <typename DNA> struct Individual {
 		o["evaluated"] = evaluated;
 		o["alreadyEval"] = wasAlreadyEvaluated;
 		o["evalTime"] = evalTime;
+		o["stats"] = stats;
 		return o;
 	}
 
@@ -161,6 +634,438 @@ template <typename DNA> struct Individual {
 		for (auto &ind : popArray) res.push_back(Individual<DNA>(ind));
 		return res;
 	}
+
+	// Binary counterparts of toJSON & popToJSON (see BinaryWriter)
+	void toBinary(BinaryWriter &w) const {
+		writeDNA(w, dna);
+		w.writeMap(fitnesses);
+		w.writeFootprint(footprint);
+		w.writeString(infos);
+		w.writeMap(stats);
+		w.write<uint8_t>(static_cast<uint8_t>((evaluated ? 1 : 0) | (wasAlreadyEvaluated ? 2 : 0)));
+		w.write(evalTime);
+	}
+
+	static Individual<DNA> fromBinary(BinaryReader &r) {
+		Individual<DNA> ind(readDNA<DNA>(r));
+		ind.fitnesses = r.readMap();
+		ind.footprint = r.readFootprint();
+		ind.flattenFootprint();
+		ind.infos = r.readString();
+		ind.stats = r.readMap();
+		auto flags = r.read<uint8_t>();
+		ind.evaluated = flags & 1;
+		ind.wasAlreadyEvaluated = flags & 2;
+		ind.evalTime = r.read<double>();
+		return ind;
+	}
+
+	// Evaluation results only (what an evaluator sets), used to send evaluated individuals
+	// back to the MPI master
+	json resultsToJSON() const {
+		json o;
+		o["fitnesses"] = fitnesses;
+		o["footprint"] = footprint;
+		o["infos"] = infos;
+		o["stats"] = stats;
+		o["evalTime"] = evalTime;
+		return o;
+	}
+
+	void resultsToBinary(BinaryWriter &w) const {
+		w.writeMap(fitnesses);
+		w.writeFootprint(footprint);
+		w.writeString(infos);
+		w.writeMap(stats);
+		w.write(evalTime);
+	}
+
+	void loadResultsFromJSON(const json &o) {
+		fitnesses = o.at("fitnesses").get<decltype(fitnesses)>();
+		footprint = o.at("footprint").get<fpType>();
+		infos = o.at("infos");
+		stats = o.at("stats").get<decltype(stats)>();
+		evalTime = o.at("evalTime");
+		evaluated = true;
+		wasAlreadyEvaluated = false;
+	}
+
+	void loadResultsFromBinary(BinaryReader &r) {
+		fitnesses = r.readMap();
+		footprint = r.readFootprint();
+		infos = r.readString();
+		stats = r.readMap();
+		evalTime = r.read<double>();
+		evaluated = true;
+		wasAlreadyEvaluated = false;
+	}
+
+	// a binary population is a count followed by length-prefixed individuals
+	static vector<char> popToBinary(const vector<Individual<DNA>> &p) {
+		vector<char> buffer;
+		BinaryWriter w(buffer);
+		w.write<uint64_t>(p.size());
+		for (auto &i : p) {
+			auto start = w.beginLengthPrefix();
+			i.toBinary(w);
+			w.endLengthPrefix(start);
+		}
+		return buffer;
+	}
+
+	static vector<Individual<DNA>> loadPopFromBinary(const char *data, size_t size) {
+		BinaryReader r(data, size);
+		auto count = static_cast<size_t>(r.read<uint64_t>());
+		vector<Individual<DNA>> res;
+		res.reserve(count);
+		for (size_t i = 0; i < count; ++i) {
+			size_t n;
+			const char *p = r.readBytes(n);
+			BinaryReader record(p, n);
+			res.push_back(fromBinary(record));
+		}
+		return res;
+	}
+};
+
+/*****************************************************************************
+ *                         BINARY POPULATION SNAPSHOTS
+ * **************************************************************************/
+// Layout of a .bpop file (native endianness):
+// "GAGAPOP\0" | uint32 version | uint32 reserved | uint64 generation | uint64 count
+// | length prefixed evaluator name | uint64 offsets[count + 1] | records
+// offsets[i] is the position of the i-th record (Individual::toBinary) from the
+// beginning of the file, and offsets[count] is the end of the last one. This lets
+// PopSnapshot decode any individual without reading the others.
+
+static const char popSnapshotMagic[8] = {'G', 'A', 'G', 'A', 'P', 'O', 'P', '\0'};
+static const uint32_t popSnapshotVersion = 1;
+// GA::checkpoint files
+static const char checkpointMagic[8] = {'G', 'A', 'G', 'A', 'C', 'K', 'P', 'T'};
+static const uint32_t checkpointVersion = 1;
+
+template <typename DNA>
+vector<char> writePopSnapshot(const vector<Individual<DNA>> &p, size_t generation,
+                              const string &evaluator) {
+	vector<char> buffer;
+	BinaryWriter w(buffer);
+	buffer.insert(buffer.end(), popSnapshotMagic, popSnapshotMagic + sizeof(popSnapshotMagic));
+	w.write<uint32_t>(popSnapshotVersion);
+	w.write<uint32_t>(0);
+	w.write<uint64_t>(generation);
+	w.write<uint64_t>(p.size());
+	w.writeString(evaluator);
+	size_t offsetTable = buffer.size();
+	buffer.resize(offsetTable + (p.size() + 1) * sizeof(uint64_t));
+	for (size_t i = 0; i <= p.size(); ++i) {
+		uint64_t offset = buffer.size();
+		std::memcpy(&buffer[offsetTable + i * sizeof(uint64_t)], &offset, sizeof(offset));
+		if (i < p.size()) p[i].toBinary(w);
+	}
+	return buffer;
+}
+
+// writes to fileName.tmp, syncs it and renames it to fileName: readers (and a restarted
+// run) either see the previous file or the complete new one
+inline void writeFileAtomically(const string &fileName, const vector<char> &buffer) {
+	string tmpName = fileName + ".tmp";
+	int fd = open(tmpName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if (fd < 0) throw std::runtime_error("Cannot open " + tmpName);
+	size_t written = 0;
+	while (written < buffer.size()) {
+		ssize_t n = write(fd, buffer.data() + written, buffer.size() - written);
+		if (n < 0) {
+			if (errno == EINTR) continue;
+			close(fd);
+			throw std::runtime_error("Cannot write " + tmpName);
+		}
+		written += static_cast<size_t>(n);
+	}
+	// a checkpoint that didn't reach the disk must not replace the previous one
+	bool synced = fsync(fd) == 0;
+	if (close(fd) != 0) synced = false;
+	if (!synced) {
+		unlink(tmpName.c_str());
+		throw std::runtime_error("Cannot sync " + tmpName);
+	}
+	if (std::rename(tmpName.c_str(), fileName.c_str()) != 0)
+		throw std::runtime_error("Cannot rename " + tmpName);
+}
+
+// Read-only, memory mapped .bpop file: individuals are decoded on demand
+template <typename DNA> class PopSnapshot {
+ public:
+	explicit PopSnapshot(const string &fileName) {
+		int fd = open(fileName.c_str(), O_RDONLY);
+		if (fd < 0) throw std::runtime_error("Cannot open " + fileName);
+		struct stat sb;
+		if (fstat(fd, &sb) != 0) {
+			close(fd);
+			throw std::runtime_error("Cannot stat " + fileName);
+		}
+		length = static_cast<size_t>(sb.st_size);
+		if (length > 0) {
+			void *m = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (m == MAP_FAILED) {
+				close(fd);
+				throw std::runtime_error("Cannot map " + fileName);
+			}
+			data = static_cast<const char *>(m);
+		}
+		close(fd);
+		try {
+			readHeader();
+		} catch (...) {
+			unmap();
+			throw;
+		}
+	}
+	~PopSnapshot() { unmap(); }
+	PopSnapshot(const PopSnapshot &) = delete;
+	PopSnapshot &operator=(const PopSnapshot &) = delete;
+
+	// true if the file starts like a binary snapshot
+	static bool isSnapshot(const string &fileName) {
+		std::ifstream f(fileName, std::ios::binary);
+		char magic[sizeof(popSnapshotMagic)] = {};
+		f.read(magic, sizeof(magic));
+		return f && std::memcmp(magic, popSnapshotMagic, sizeof(magic)) == 0;
+	}
+
+	size_t size() const { return count; }
+	size_t generation() const { return gen; }
+	const string &evaluator() const { return evaluatorName; }
+
+	Individual<DNA> get(size_t i) const {
+		if (i >= count) throw std::out_of_range("No such individual in the snapshot");
+		uint64_t begin = offset(i), end = offset(i + 1);
+		if (begin > end || end > length) throw std::runtime_error("Corrupted population snapshot");
+		BinaryReader r(data + begin, end - begin);
+		return Individual<DNA>::fromBinary(r);
+	}
+	Individual<DNA> operator[](size_t i) const { return get(i); }
+
+	vector<Individual<DNA>> loadAll() const {
+		vector<Individual<DNA>> res;
+		res.reserve(count);
+		for (size_t i = 0; i < count; ++i) res.push_back(get(i));
+		return res;
+	}
+
+ protected:
+	const char *data = nullptr;
+	size_t length = 0;
+	size_t count = 0;
+	size_t gen = 0;
+	string evaluatorName;
+	const char *offsets = nullptr;
+
+	void readHeader() {
+		BinaryReader r(data, length);
+		if (length < sizeof(popSnapshotMagic) ||
+		    std::memcmp(r.skip(sizeof(popSnapshotMagic)), popSnapshotMagic,
+		                sizeof(popSnapshotMagic)) != 0)
+			throw std::runtime_error("Not a gaga population snapshot");
+		auto version = r.read<uint32_t>();
+		if (version != popSnapshotVersion)
+			throw std::runtime_error("Unsupported population snapshot version " +
+			                         std::to_string(version));
+		r.read<uint32_t>();
+		gen = static_cast<size_t>(r.read<uint64_t>());
+		count = static_cast<size_t>(r.read<uint64_t>());
+		evaluatorName = r.readString();
+		if (count >= static_cast<size_t>(r.end - r.cur) / sizeof(uint64_t))
+			throw std::runtime_error("Truncated binary buffer");
+		offsets = r.skip((count + 1) * sizeof(uint64_t));
+	}
+	uint64_t offset(size_t i) const {
+		uint64_t o;
+		std::memcpy(&o, offsets + i * sizeof(uint64_t), sizeof(o));
+		return o;
+	}
+	void unmap() {
+		if (data) munmap(const_cast<char *>(data), length);
+		data = nullptr;
+	}
+};
+
+/*****************************************************************************
+ *                         NOVELTY ARCHIVE ENTRIES
+ * **************************************************************************/
+// The novelty archive only keeps what novelty needs (the flattened footprint) plus
+// a shared, immutable copy of the DNA when archived DNAs are wanted (see
+// GA::enableArchiveDNA), instead of whole individuals.
+template <typename DNA> struct ArchiveEntry {
+	FlatFootprint footprint;
+	std::shared_ptr<const DNA> dna;  // null when DNAs aren't kept in the archive
+	size_t id = 0;                   // insertion order in the archive
+	size_t generation = 0;           // generation at which it entered the archive
+	double novelty = 0;              // its novelty at that time
+
+	ArchiveEntry() {}
+	ArchiveEntry(const Individual<DNA> &ind, bool keepDNA) : footprint(ind.flatFootprint) {
+		if (keepDNA) dna = std::make_shared<const DNA>(ind.dna);
+	}
+	explicit ArchiveEntry(const json &o) {
+		if (o.count("dna")) dna = std::make_shared<const DNA>(o.at("dna").get<string>());
+		footprint.assign(o.at("footprint").get<fpType>());
+		novelty = o.at("fitnesses").at("novelty");
+		if (o.count("id")) id = o.at("id");
+		if (o.count("generation")) generation = o.at("generation");
+	}
+
+	// same layout as Individual::toJSON (+ id & generation), so that archive files can
+	// still be loaded as populations when they contain DNAs
+	json toJSON() const {
+		json o;
+		if (dna) o["dna"] = dna->serialize();
+		o["footprint"] = footprint.toFpType();
+		o["fitnesses"] = {{"novelty", novelty}};
+		o["id"] = id;
+		o["generation"] = generation;
+		return o;
+	}
+
+	void toBinary(BinaryWriter &w) const {
+		w.writeFootprint(footprint.toFpType());
+		w.write<uint8_t>(dna ? 1 : 0);
+		if (dna) writeDNA(w, *dna);
+		w.write<uint64_t>(id);
+		w.write<uint64_t>(generation);
+		w.write(novelty);
+	}
+	static ArchiveEntry fromBinary(BinaryReader &r) {
+		ArchiveEntry e;
+		e.footprint.assign(r.readFootprint());
+		if (r.read<uint8_t>()) e.dna = std::make_shared<const DNA>(readDNA<DNA>(r));
+		e.id = static_cast<size_t>(r.read<uint64_t>());
+		e.generation = static_cast<size_t>(r.read<uint64_t>());
+		e.novelty = r.read<double>();
+		return e;
+	}
+};
+
+/*****************************************************************************
+ *                         BACKGROUND WRITER
+ * **************************************************************************/
+// Runs save tasks, in submission order, on a dedicated thread. push() blocks while
+// maxQueued tasks are already waiting, so that a slow disk can't make snapshots of
+// the population pile up in memory. flush() waits until everything is written.
+class AsyncWriter {
+ public:
+	explicit AsyncWriter(size_t maxQueued) : capacity(std::max<size_t>(maxQueued, 1)) {
+		worker = std::thread([this]() { run(); });
+	}
+	~AsyncWriter() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		workCV.notify_all();
+		worker.join();  // the remaining tasks are run first
+	}
+	AsyncWriter(const AsyncWriter &) = delete;
+	AsyncWriter &operator=(const AsyncWriter &) = delete;
+
+	void push(std::function<void()> task) {
+		std::unique_lock<std::mutex> lock(mutex);
+		spaceCV.wait(lock, [this]() { return tasks.size() < capacity; });
+		tasks.push_back(std::move(task));
+		workCV.notify_one();
+	}
+	void flush() {
+		std::unique_lock<std::mutex> lock(mutex);
+		doneCV.wait(lock, [this]() { return tasks.empty() && !busy; });
+	}
+
+ protected:
+	size_t capacity;
+	std::deque<std::function<void()>> tasks;
+	bool busy = false;
+	bool stopping = false;
+	std::mutex mutex;
+	std::condition_variable workCV, spaceCV, doneCV;
+	std::thread worker;
+
+	void run() {
+		std::unique_lock<std::mutex> lock(mutex);
+		for (;;) {
+			workCV.wait(lock, [this]() { return stopping || !tasks.empty(); });
+			if (tasks.empty()) return;
+			auto task = std::move(tasks.front());
+			tasks.pop_front();
+			busy = true;
+			spaceCV.notify_one();
+			lock.unlock();
+			try {
+				task();
+			} catch (const std::exception &e) {
+				cerr << "Error while saving: " << e.what() << endl;
+			}
+			lock.lock();
+			busy = false;
+			if (tasks.empty()) doneCV.notify_all();
+		}
+	}
+};
+
+/*****************************************************************************
+ *                         EVALUATION CACHE
+ * **************************************************************************/
+// What an evaluator sets in an individual
+struct CachedEvaluation {
+	map<string, double> fitnesses;
+	fpType footprint;
+	string infos;
+	map<string, double> stats;
+};
+
+// Evaluation results indexed by DNA hash, bounded to maxSize entries: the least
+// recently used one is dropped to make room. Thread safe.
+class EvaluationCache {
+ public:
+	explicit EvaluationCache(size_t maxSize) : capacity(std::max<size_t>(maxSize, 1)) {}
+
+	bool get(size_t hash, CachedEvaluation &res) {
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = index.find(hash);
+		if (it == index.end()) return false;
+		entries.splice(entries.begin(), entries, it->second);  // most recently used first
+		res = it->second->second;
+		return true;
+	}
+	void put(size_t hash, CachedEvaluation e) {
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = index.find(hash);
+		if (it != index.end()) {
+			it->second->second = std::move(e);
+			entries.splice(entries.begin(), entries, it->second);
+			return;
+		}
+		entries.emplace_front(hash, std::move(e));
+		index[hash] = entries.begin();
+		if (entries.size() > capacity) {
+			index.erase(entries.back().first);
+			entries.pop_back();
+		}
+	}
+	void clear() {
+		std::lock_guard<std::mutex> lock(mutex);
+		entries.clear();
+		index.clear();
+	}
+	size_t size() const {
+		std::lock_guard<std::mutex> lock(mutex);
+		return entries.size();
+	}
+	size_t maxSize() const { return capacity; }
+
+ protected:
+	using Entries = std::list<std::pair<size_t, CachedEvaluation>>;
+	size_t capacity;
+	Entries entries;
+	unordered_map<size_t, Entries::iterator> index;
+	mutable std::mutex mutex;
 };
 
 /*********************************************************************************
@@ -179,8 +1084,42 @@ template <typename DNA> struct Individual {
 // ga.setPopSize(400);
 // return ga.start();
 
-enum class SelectionMethod { paretoTournament, randomObjTournament };
-template <typename DNA> class GA {
+enum class SelectionMethod { paretoTournament, randomObjTournament, nsga2Tournament };
+// MPI scheduling: static batches (one per proc) or small chunks handed out on demand
+enum class MPIScheduling { batches, onDemand };
+// which entries leave a full novelty archive: the oldest ones, random ones, the least
+// novel ones (novelty when they entered) or the ones in the most crowded regions
+enum class ArchiveEviction { fifo, random, leastNovel, density };
+
+// Compile time policies, for GA's Compare and Selection template parameters. With the
+// Dynamic ones (default), comparison and selection are chosen at runtime
+// (setIsBetterMethod, setSelectionMethod); fixed ones can be inlined in the breeding
+// and dominance loops. ex: GA<DNA, Maximize, RandomObjTournamentSelection>
+struct Maximize {
+	bool operator()(double a, double b) const { return a > b; }
+};
+struct Minimize {
+	bool operator()(double a, double b) const { return a < b; }
+};
+struct DynamicCompare {
+	std::function<bool(double, double)> f = [](double a, double b) { return a > b; };
+	DynamicCompare() {}
+	explicit DynamicCompare(std::function<bool(double, double)> g) : f(std::move(g)) {}
+	bool operator()(double a, double b) const { return f(a, b); }
+};
+struct ParetoTournamentSelection {
+	static SelectionMethod method() { return SelectionMethod::paretoTournament; }
+};
+struct RandomObjTournamentSelection {
+	static SelectionMethod method() { return SelectionMethod::randomObjTournament; }
+};
+struct NSGA2TournamentSelection {
+	static SelectionMethod method() { return SelectionMethod::nsga2Tournament; }
+};
+struct DynamicSelection {};
+
+template <typename DNA, typename Compare = DynamicCompare, typename Selection = DynamicSelection>
+class GA {
  protected:
 	/*********************************************************************************
 	 *                            MAIN GA SETTINGS
@@ -192,8 +1131,10 @@ template <typename DNA> class GA {
 	size_t nbSavedElites = 1;             // nb of elites to save
 	size_t tournamentSize = 3;            // nb of competitors in tournament
 	bool savePopEnabled = true;           // save the whole population
+	bool binaryPopSave = true;            // .bpop snapshots (json .pop otherwise)
 	unsigned int savePopInterval = 1;     // interval between 2 whole population saves
 	unsigned int saveGenInterval = 1;     // interval between 2 elites/pareto saves
+	size_t checkpointInterval = 0;        // nb of generations between 2 checkpoints (0 = never)
 	string folder = "../evos/";           // where to save the results
 	string evaluatorName;                 // name of the given evaluator func
 	double crossoverProba = 0.2;          // crossover probability
@@ -201,14 +1142,32 @@ template <typename DNA> class GA {
 	bool evaluateAllIndividuals = false;  // force evaluation of every individual
 	bool doSaveParetoFront = false;       // save the pareto front
 	bool doSaveGenStats = true;           // save generations stats to csv file
+	size_t genStatsFlushInterval = 1;     // nb of generations between 2 csv flushes
+	size_t genStatsHistory = 0;           // nb of generations stats kept in memory (0 = all)
 	bool doSaveIndStats = false;          // save individuals stats to csv file
+	size_t asyncSaveQueueSize = 0;        // max pending saves of the I/O thread (0 = sync)
+	std::function<size_t(const DNA &)> dnaHasher = [](const DNA &d) {
+		return std::hash<string>()(d.serialize());
+	};  // evaluation cache keys
 	SelectionMethod selecMethod = SelectionMethod::paretoTournament;
+	bool binaryTransfer = hasBinarySerialization<DNA>::value;  // MPI wire format
+	MPIScheduling mpiScheduling = MPIScheduling::batches;
+	size_t MPIChunkSize = 0;         // nb of individuals per chunk (0 = adaptive)
+	double MPIChunkTargetTime = 1;   // adaptive chunks aim at this evaluation time (s)
+	double avgEvalTime = 0;          // moving average of the observed evaluation times
+	bool steadyState = false;        // asynchronous steady state evolution (no generations)
 
 	// for novelty:
 	bool novelty = false;             // enable novelty
 	double minNoveltyForArchive = 1;  // min novelty for being added to the general archive
 	size_t KNN = 15;                  // size of the neighbourhood for novelty
 	bool saveArchiveEnabled = true;   // save the novelty archive
+	size_t archiveSnapshotInterval = 10;  // nb of generations between 2 full archive saves
+	bool archiveDNA = true;           // keep the DNAs of archived individuals
+	size_t maxArchiveSize = 0;        // 0 = unbounded
+	ArchiveEviction archiveEviction = ArchiveEviction::fifo;
+	bool noveltyIndex = false;        // search the archive through a KD-tree
+	size_t noveltyIndexMaxLeafChecks = 0;  // approximate index search (0 = exact)
 
 	// for speciation:
 	bool speciation = false;           // enable speciation
@@ -219,7 +1178,11 @@ template <typename DNA> class GA {
 	double speciationThresholdIncrement = 0.01;
 	std::function<double(const Individual<DNA> &, const Individual<DNA> &)>
 	    indDistanceFunction = [](const auto &, const auto &) { return 0.0; };
-	const unsigned int MAX_SPECIATION_TRIES = 100;
+	// optional: computes the distances of many pairs of individuals in one call
+	std::function<void(const vector<std::pair<const Individual<DNA> *, const Individual<DNA> *>> &,
+	                   vector<double> &)>
+	    indDistanceBatchFunction = nullptr;
+	const unsigned int MAX_SPECIATION_TRIES = 100;  // rounds of draws to refill the species
 	vector<double> speciationThresholds;  // spec thresholds per specie
 
 	/********************************************************************************
@@ -230,18 +1193,40 @@ template <typename DNA> class GA {
 	using DNA_t = DNA;
 	void enablePopulationSave() { savePopEnabled = true; }
 	void disablePopulationSave() { savePopEnabled = false; }
+	// populations are saved as binary snapshots (genN/popN.bpop, see PopSnapshot) or
+	// exported as json (genN/popN.pop)
+	void enableBinaryPopSave() { binaryPopSave = true; }
+	void disableBinaryPopSave() { binaryPopSave = false; }
 	void enableArchiveSave() { saveArchiveEnabled = true; }
 	void disableArchiveSave() { saveArchiveEnabled = false; }
+	// archive saves append their changes to archive.log; a complete snapshot is written
+	// every n generations (0 = never)
+	void setArchiveSnapshotInterval(size_t n) { archiveSnapshotInterval = n; }
+	void enableBinaryTransfer() { binaryTransfer = true; }
+	void disableBinaryTransfer() { binaryTransfer = false; }
+	void setMPIScheduling(const MPIScheduling &s) { mpiScheduling = s; }
+	void setMPIChunkSize(size_t n) { MPIChunkSize = n; }
+	void setMPIChunkTargetTime(double t) { MPIChunkTargetTime = t; }
+	void enableSteadyState() { steadyState = true; }
+	void disableSteadyState() { steadyState = false; }
+	bool steadyStateEnabled() { return steadyState; }
 	void setVerbosity(unsigned int lvl) { verbosity = lvl <= 3 ? (lvl >= 0 ? lvl : 0) : 3; }
 	void setPopSize(size_t s) { popSize = s; }
 	size_t getPopSize() { return popSize; }
+	size_t getCurrentGeneration() { return currentGeneration; }
 	void setNbElites(size_t n) { nbElites = n; }
 	size_t getNbElites() { return nbElites; }
 	void setNbSavedElites(size_t n) { nbSavedElites = n; }
 	void setTournamentSize(size_t n) { tournamentSize = n; }
 	void setPopSaveInterval(unsigned int n) { savePopInterval = n; }
 	void setGenSaveInterval(unsigned int n) { saveGenInterval = n; }
+	// the whole state of the run is saved to saveFolder/checkpoint.bin every n
+	// generations (see checkpoint() and restore()). 0 = never
+	void setCheckpointInterval(size_t n) { checkpointInterval = n; }
+	size_t getCheckpointInterval() { return checkpointInterval; }
 	void setSaveFolder(string s) { folder = s; }
+	// once the run has started, the run's own subfolder of the save folder
+	string getSaveFolder() { return folder; }
 	void setCrossoverProba(double p) {
 		crossoverProba = p <= 1.0 ? (p >= 0.0 ? p : 0.0) : 1.0;
 	}
@@ -254,6 +1239,7 @@ template <typename DNA> class GA {
 	                  std::string ename = "anonymousEvaluator") {
 		evaluator = e;
 		evaluatorName = ename;
+		if (evalCache) evalCache->clear();
 		for (auto &i : population) {
 			i.evaluated = false;
 			i.wasAlreadyEvaluated = false;
@@ -264,27 +1250,89 @@ template <typename DNA> class GA {
 		newGenerationFunction = f;
 	}  // called before evaluating the current population
 
-	void setIsBetterMethod(std::function<bool(double, double)> f) { isBetter = f; }
-	void setSelectionMethod(const SelectionMethod &sm) { selecMethod = sm; }
+	void setIsBetterMethod(std::function<bool(double, double)> f) {
+		static_assert(std::is_same<Compare, DynamicCompare>::value,
+		              "the comparison is fixed by the Compare template parameter");
+		isBetter = Compare(f);
+	}
+	void setSelectionMethod(const SelectionMethod &sm) {
+		static_assert(std::is_same<Selection, DynamicSelection>::value,
+		              "the selection method is fixed by the Selection template parameter");
+		selecMethod = sm;
+	}
+	SelectionMethod selectionMethod() const { return selectionMethod(Selection()); }
 
 	template <typename S> std::function<Individual<DNA> *(S &)> getSelectionMethod() {
-		switch (selecMethod) {
-			case SelectionMethod::paretoTournament:
-				return [this](S &subPop) { return paretoTournament(subPop); };
-			case SelectionMethod::randomObjTournament:
-			default:
-				return [this](S &subPop) { return randomObjTournament(subPop); };
-		}
+		return [this](S &subPop) { return selectParent(subPop); };
+	}
+
+	// one parent out of subPop, with the selection method of the Selection policy
+	template <typename S> Individual<DNA> *selectParent(S &subPop) {
+		return selectParent(subPop, Selection());
+	}
+
+	// some selection methods need per generation preprocessing of the subpopulation
+	template <typename S> void prepareSelection(S &subPop) {
+		if (selectionMethod() == SelectionMethod::nsga2Tournament) computeNSGA2Ranks(subPop);
 	}
 
 	void setEvaluateAllIndividuals(bool m) { evaluateAllIndividuals = m; }
 	void setSaveParetoFront(bool m) { doSaveParetoFront = m; }
 	void setSaveGenStats(bool m) { doSaveGenStats = m; }
+	// gen_stats.csv is append only: rows are flushed every n generations
+	void setGenStatsFlushInterval(size_t n) { genStatsFlushInterval = std::max<size_t>(n, 1); }
+	// only the last n generations stats are kept in memory (0 = all of them)
+	void setGenStatsHistory(size_t n) { genStatsHistory = n; }
 	void setSaveIndStats(bool m) { doSaveIndStats = m; }
+	// Individuals whose DNA was evaluated recently get the cached results instead of a
+	// new evaluation (identical DNAs of a same generation are evaluated once). At most
+	// maxSize results are kept, the least recently used ones are dropped. Only for
+	// deterministic evaluators; ignored when evaluateAllIndividuals is set.
+	void enableEvaluationCache(size_t maxSize = 10000) {
+		evalCache.reset(new EvaluationCache(maxSize));
+	}
+	void disableEvaluationCache() { evalCache.reset(); }
+	bool evaluationCacheEnabled() { return evalCache != nullptr; }
+	// cache keys. DNAs with the same hash are considered identical. Default: std::hash of
+	// dna.serialize()
+	void setDNAHasher(std::function<size_t(const DNA &)> h) {
+		dnaHasher = h;
+		if (evalCache) evalCache->clear();
+	}
+	// Saves (populations, archive, elites, stats) are written by a background thread: the
+	// data to save is copied between two generations, and the files are written while
+	// the next one runs. At most queueSize saves can be pending (the next one waits).
+	void enableAsyncSaves(size_t queueSize = 8) {
+		flushSaves();
+		asyncSaveQueueSize = std::max<size_t>(queueSize, 1);
+		ioThread.reset(new AsyncWriter(asyncSaveQueueSize));
+	}
+	void disableAsyncSaves() {
+		flushSaves();
+		ioThread.reset();
+		asyncSaveQueueSize = 0;
+	}
+	bool asyncSavesEnabled() { return ioThread != nullptr; }
+	// waits until every pending save is written, gen_stats.csv rows included (called at
+	// destruction)
+	void flushSaves() {
+		runSave([this]() {
+			if (genStatsFile.is_open()) genStatsFile.flush();
+			genStatsRowsSinceFlush = 0;
+		});
+		if (ioThread) ioThread->flush();
+	}
 
 	// main current and previous population containers
 	vector<Individual<DNA>> population;
 	vector<Individual<DNA>> lastGen;
+	// stats of the last generations (see setGenStatsHistory):
+	// {category (objective, "global", ...) -> {stat -> value}}
+	const std::deque<std::map<std::string, std::map<std::string, double>>> &getGenStats() const {
+		return genStats;
+	}
+	// generation number of getGenStats()[0]
+	size_t getGenStatsOffset() const { return genStatsOffset; }
 
 	// for novelty:
 	void enableNovelty() { novelty = true; }
@@ -294,6 +1342,25 @@ template <typename DNA> class GA {
 	size_t getKNN() { return KNN; }
 	void setMinNoveltyForArchive(double m) { minNoveltyForArchive = m; }
 	double getMinNoveltyForArchive() { return minNoveltyForArchive; }
+	// keep (a copy of) the DNA of archived individuals. Without it, the archive only
+	// stores footprints, and saved archives can't be reloaded as populations.
+	void enableArchiveDNA() { archiveDNA = true; }
+	void disableArchiveDNA() { archiveDNA = false; }
+	bool archiveDNAEnabled() { return archiveDNA; }
+	const vector<ArchiveEntry<DNA>> &getArchive() const { return archive; }
+	// max nb of entries in the archive (0 = unbounded). Entries are evicted at the end
+	// of updateNovelty, according to the eviction policy.
+	void setMaxArchiveSize(size_t n) { maxArchiveSize = n; }
+	size_t getMaxArchiveSize() { return maxArchiveSize; }
+	void setArchiveEviction(ArchiveEviction e) { archiveEviction = e; }
+	ArchiveEviction getArchiveEviction() { return archiveEviction; }
+	// KD-tree index over the archive footprints (for large archives)
+	void enableNoveltyIndex() { noveltyIndex = true; }
+	void disableNoveltyIndex() { noveltyIndex = false; }
+	bool noveltyIndexEnabled() { return noveltyIndex; }
+	// max nb of leaves visited by an index query: trades recall for speed (0 = exact)
+	void setNoveltyIndexMaxLeafChecks(size_t n) { noveltyIndexMaxLeafChecks = n; }
+	size_t getNoveltyIndexMaxLeafChecks() { return noveltyIndexMaxLeafChecks; }
 
 	// for speciation:
 	void enableSpeciation() {
@@ -320,43 +1387,223 @@ template <typename DNA> class GA {
 	    std::function<double(const Individual<DNA> &, const Individual<DNA> &)> f) {
 		indDistanceFunction = f;
 	}
-	vector<vector<Iptr>> species;  // pointers to the individuals of the species
+	// f(pairs, distances) must fill distances (already sized) with the distance of each pair
+	void setIndDistanceBatchFunction(
+	    std::function<void(
+	        const vector<std::pair<const Individual<DNA> *, const Individual<DNA> *>> &,
+	        vector<double> &)>
+	        f) {
+		indDistanceBatchFunction = f;
+	}
+	vector<vector<size_t>> species;  // indices of the individuals of the species in population
+
+	// Objective registry: each objective name gets a fixed index the first time it is
+	// seen, and fitnesses are mirrored in every individual's dense objectives vector.
+	// Selection, elitism and stats loops work on these vectors; the fitnesses map stays
+	// the interface for evaluators (and for saving). The vectors are refreshed once per
+	// individual, after its evaluation (see evaluate) and when novelty is written; the
+	// rest of the code assumes they are up to date.
+	vector<string> objectiveNames;
+	size_t getObjectiveId(const string &name) {
+		auto it = objectiveIds.find(name);
+		if (it != objectiveIds.end()) return it->second;
+		objectiveIds[name] = objectiveNames.size();
+		objectiveNames.push_back(name);
+		return objectiveNames.size() - 1;
+	}
+	// objectives missing from an individual's fitnesses are set to NaN
+	void updateObjectives(Individual<DNA> &ind) {
+		ind.objectives.assign(objectiveNames.size(), std::numeric_limits<double>::quiet_NaN());
+		for (const auto &f : ind.fitnesses) {
+			size_t id = getObjectiveId(f.first);
+			if (id >= ind.objectives.size())
+				ind.objectives.resize(id + 1, std::numeric_limits<double>::quiet_NaN());
+			ind.objectives[id] = f.second;
+		}
+	}
+	template <typename I> void updateObjectives(vector<I> &popu) {
+		for (auto &i : popu) updateObjectives(ref(i));
+		padObjectives(popu);
+	}
+	// gives the objectives registered in the meantime (NaN) to individuals whose
+	// objectives are otherwise up to date
+	template <typename I> void padObjectives(vector<I> &popu) {
+		for (auto &i : popu)
+			ref(i).objectives.resize(objectiveNames.size(), std::numeric_limits<double>::quiet_NaN());
+	}
+	// (for debug asserts)
+	template <typename I> bool objectivesUpToDate(const vector<I> &popu) const {
+		for (const auto &i : popu) {
+			const auto &ind = ref(i);
+			if (ind.objectives.size() != objectiveNames.size()) return false;
+			for (const auto &f : ind.fitnesses) {
+				auto id = objectiveIds.find(f.first);
+				if (id == objectiveIds.end()) return false;
+				double o = ind.objectives[id->second];
+				if (o != f.second && !(std::isnan(o) && std::isnan(f.second))) return false;
+			}
+		}
+		return true;
+	}
 
 	////////////////////////////////////////////////////////////////////////////////////
 
 	std::random_device rd;
 	std::default_random_engine globalRand = std::default_random_engine(rd());
 
+	// Each OpenMP thread draws from its own engine (globalRand for the master thread),
+	// so that parallel breeding neither races nor shares cache lines. With the same seed
+	// and the same number of threads, a run can be replayed exactly.
+	void setSeed(unsigned int s) {
+		rngSeed = s;
+		globalRand.seed(s);
+		rngPool.clear();
+		updateRNGPool();
+	}
+	unsigned int getSeed() { return rngSeed; }
+
+	// returns the calling thread's engine
+	std::default_random_engine &getRNG() {
+#ifdef OMP
+		size_t t = static_cast<size_t>(omp_get_thread_num());
+		if (t > 0) {
+			assert(t < rngPool.size());
+			return rngPool[t].engine;
+		}
+#endif
+		return globalRand;
+	}
+
  protected:
-	vector<Individual<DNA>>
+	vector<ArchiveEntry<DNA>>
 	    archive;  // when novelty is enabled, we store the novel individuals there
+	size_t nextArchiveId = 0;
+	size_t archiveEvictions = 0;  // during the last novelty update
+	// archive.log writer: entries with an id >= savedArchiveId and the evictions below
+	// haven't been saved yet
+	std::ofstream archiveLogFile;
+	size_t savedArchiveId = 0;
+	vector<size_t> unsavedEvictions;
+	FootprintKDTree archiveIndex;  // footprints of archive[0, indexedArchiveSize)
+	size_t indexedArchiveSize = 0;
+	vector<size_t> archivePointIds;  // id of archive[i] in archiveIndex
+	size_t archiveIndexRebuilds = 0;  // during the last novelty update
+	// steady state: offspring read the archive outside of the steady state lock, it is
+	// only modified under this mutex in the meantime
+	mutable std::shared_timed_mutex archiveMutex;
 	size_t currentGeneration = 0;
+	size_t lastCheckpointGeneration = 0;
 	bool customInit = false;
+	// per thread random engines, padded so that they don't share cache lines
+	struct ThreadRNG {
+		std::default_random_engine engine;
+		char padding[64];
+	};
+	vector<ThreadRNG> rngPool;
+	unsigned int rngSeed = 0;
+	unordered_map<string, size_t> objectiveIds;  // objective registry (see objectiveNames)
+	// for steady state:
+	size_t steadyStateEvals = 0;     // nb of evaluations in the current virtual generation
+	size_t steadyStateLastGen = 0;   // virtual generation at which the current step ends
+	size_t steadyStateNbEvals = 0;   // nb of offspring to dispatch during the current step
+	// nb of offspring that can be dispatched (since the start of the step) before the next
+	// checkpoint: see steadyStateDispatchLimit()
+	size_t steadyStateMaxDispatch = 0;
+	high_resolution_clock::time_point genStartTime;
 	// openmp/mpi stuff
 	int procId = 0;
 	int nbProcs = 1;
 	int argc = 1;
 	char **argv = nullptr;
 
-	std::vector<std::map<std::string, std::map<std::string, double>>> genStats;
+	std::deque<std::map<std::string, std::map<std::string, double>>> genStats;
+	size_t genStatsOffset = 0;  // generation of genStats[0]
+	// gen_stats.csv writer: columns ({category, stat}) in file order
+	std::ofstream genStatsFile;
+	vector<std::pair<string, string>> genStatsColumns;
+	size_t genStatsRowsSinceFlush = 0;
+	std::unique_ptr<AsyncWriter> ioThread;  // see enableAsyncSaves
+	std::unique_ptr<EvaluationCache> evalCache;  // see enableEvaluationCache
+	// cache lookups and hits since the last stats. They are counted and reset together, so
+	// that a hit is never reported in another generation than its lookup.
+	std::mutex cacheStatsMutex;
+	size_t cacheLookups = 0, cacheHits = 0;
+	void countCacheLookups(size_t lookups, size_t hits) {
+		std::lock_guard<std::mutex> lock(cacheStatsMutex);
+		cacheLookups += lookups;
+		cacheHits += hits;
+	}
+
+	// runs a save task in the background when async saves are enabled. Tasks must only
+	// use what they captured, plus the files the other save tasks write.
+	void runSave(std::function<void()> task) {
+		if (ioThread)
+			ioThread->push(std::move(task));
+		else
+			task();
+	}
+	// data for a save task: a copy when saves run in the background, the data itself
+	// otherwise
+	template <typename T> std::shared_ptr<const T> saveSnapshot(const T &data) {
+		if (ioThread) return std::make_shared<const T>(data);
+		return std::shared_ptr<const T>(&data, [](const T *) {});
+	}
 
 	std::function<void(Individual<DNA> &)> evaluator;
 	std::function<void(void)> newGenerationFunction = []() {};
 	std::function<void(void)> nextGeneration = [this]() { classicNextGen(); };
-	std::function<bool(double, double)> isBetter = [](double a, double b) { return a > b; };
+	Compare isBetter;
+
+	// tag dispatch of selectionMethod() & selectParent()
+	template <typename P> SelectionMethod selectionMethod(P) const { return P::method(); }
+	SelectionMethod selectionMethod(DynamicSelection) const { return selecMethod; }
+	template <typename S> Individual<DNA> *selectParent(S &subPop, ParetoTournamentSelection) {
+		return paretoTournament(subPop);
+	}
+	template <typename S> Individual<DNA> *selectParent(S &subPop, NSGA2TournamentSelection) {
+		return nsga2Tournament(subPop);
+	}
+	template <typename S>
+	Individual<DNA> *selectParent(S &subPop, RandomObjTournamentSelection) {
+		return randomObjTournament(subPop);
+	}
+	template <typename S> Individual<DNA> *selectParent(S &subPop, DynamicSelection) {
+		switch (selecMethod) {
+			case SelectionMethod::paretoTournament:
+				return paretoTournament(subPop);
+			case SelectionMethod::nsga2Tournament:
+				return nsga2Tournament(subPop);
+			case SelectionMethod::randomObjTournament:
+			default:
+				return randomObjTournament(subPop);
+		}
+	}
 
 	// returns a reference (transforms pointer into reference)
-	template <typename T> inline T &ref(T &obj) { return obj; }
-	template <typename T> inline T &ref(T *obj) { return *obj; }
-	template <typename T> inline const T &ref(const T &obj) { return obj; }
-	template <typename T> inline const T &ref(const T *obj) { return *obj; }
+	template <typename T> static inline T &ref(T &obj) { return obj; }
+	template <typename T> static inline T &ref(T *obj) { return *obj; }
+	template <typename T> static inline const T &ref(const T &obj) { return obj; }
+	template <typename T> static inline const T &ref(const T *obj) { return *obj; }
+
+	// makes sure every OpenMP thread has its engine. Must be called outside of
+	// parallel regions (the number of threads can change between two of them).
+	void updateRNGPool() {
+#ifdef OMP
+		size_t nbThreads = static_cast<size_t>(omp_get_max_threads());
+		for (size_t t = rngPool.size(); t < nbThreads; ++t) {
+			std::seed_seq seq{rngSeed, static_cast<unsigned int>(t)};
+			rngPool.push_back(ThreadRNG());
+			rngPool.back().engine.seed(seq);
+		}
+#endif
+	}
 
  public:
 	/*********************************************************************************
 	 *                              CONSTRUCTOR
 	 ********************************************************************************/
 	GA(int ac, char **av) : argc(ac), argv(av) {
-		setSelectionMethod(selecMethod);
+		setSeed(rd());
 #ifdef CLUSTER
 		MPI_Init(&argc, &argv);
 		MPI_Comm_size(MPI_COMM_WORLD, &nbProcs);
@@ -374,6 +1621,8 @@ template <typename DNA> class GA {
 	}
 
 	~GA() {
+		flushSaves();
+		ioThread.reset();
 #ifdef CLUSTER
 		MPI_Finalize();
 #endif
@@ -387,6 +1636,7 @@ template <typename DNA> class GA {
 			population = p;
 			if (population.size() != popSize)
 				throw std::invalid_argument("Population doesn't match the popSize param");
+			updateObjectives(population);
 			popSize = population.size();
 		}
 	}
@@ -403,106 +1653,559 @@ template <typename DNA> class GA {
 	}
 
 	void evaluate() {
+		// the individuals whose objectives need a refresh afterwards
+		vector<bool> toRefresh(population.size());
+		for (size_t i = 0; i < population.size(); ++i)
+			toRefresh[i] = evaluateAllIndividuals || !population[i].evaluated;
+		// cache keys of the individuals to evaluate (on the master)
+		vector<size_t> hashes;
+		vector<size_t> cacheState;
+		const bool useCache = evalCache && procId == 0 && !evaluateAllIndividuals;
+		if (useCache) evaluateFromCache(population, hashes, cacheState);
 #ifdef CLUSTER
-		MPI_distributePopulation();
+		if (nbProcs > 1) {
+			if (mpiScheduling == MPIScheduling::batches)
+				MPI_evaluateBatches();
+			else if (procId == 0)
+				MPI_serveEvaluations();
+			else
+				MPI_requestEvaluations();
+		} else {
+			evaluateLocally(population);
+		}
+#else
+		evaluateLocally(population);
 #endif
+		if (useCache) cacheEvaluations(population, hashes, cacheState);
+		if (procId != 0) return;  // (MPI workers' population is only made of tasks)
+		for (size_t i = 0; i < population.size(); ++i)
+			if (toRefresh[i]) updateObjectives(population[i]);
+		padObjectives(population);
+	}
+
+	// cacheState values for evaluateFromCache/cacheEvaluations: nothing to do (evaluated
+	// before, or cache hit), to be evaluated then cached, or else a duplicate waiting for
+	// the results of population[cacheState - 2]
+	enum : size_t { notCached = 0, toCache = 1 };
+
+	// individuals found in the cache are given their results (and will be reported as
+	// already evaluated), the evaluation of duplicates is left to the first of them
+	void evaluateFromCache(vector<Individual<DNA>> &p, vector<size_t> &hashes,
+	                       vector<size_t> &cacheState) {
+		hashes.assign(p.size(), 0);
+		cacheState.assign(p.size(), notCached);
 #ifdef OMP
-#pragma omp parallel for schedule(dynamic, 1)
+#pragma omp parallel for schedule(dynamic, 16)
 #endif
-		for (size_t i = 0; i < population.size(); ++i) {
-			if (evaluateAllIndividuals || !population[i].evaluated) {
-				auto t0 = high_resolution_clock::now();
-				population[i].dna.reset();
-				evaluator(population[i]);
-				auto t1 = high_resolution_clock::now();
-				population[i].evaluated = true;
-				double indTime = std::chrono::duration<double>(t1 - t0).count();
-				population[i].evalTime = indTime;
-				population[i].wasAlreadyEvaluated = false;
-			} else {
-				population[i].evalTime = 0.0;
-				population[i].wasAlreadyEvaluated = true;
+		for (size_t i = 0; i < p.size(); ++i) {
+			if (p[i].evaluated) continue;
+			hashes[i] = dnaHasher(p[i].dna);
+			if (!fetchEvaluation(p[i], hashes[i])) cacheState[i] = toCache;
+		}
+		unordered_map<size_t, size_t> firstOccurrence;
+		for (size_t i = 0; i < p.size(); ++i) {
+			if (cacheState[i] != toCache) continue;
+			auto first = firstOccurrence.emplace(hashes[i], i);
+			if (!first.second) {
+				cacheState[i] = first.first->second + 2;
+				p[i].evaluated = true;  // skipped by the evaluation
 			}
-			if (verbosity >= 2) printIndividualStats(population[i]);
 		}
-#ifdef CLUSTER
-		MPI_receivePopulation();
+	}
+
+	void cacheEvaluations(vector<Individual<DNA>> &p, const vector<size_t> &hashes,
+	                      const vector<size_t> &cacheState) {
+		for (size_t i = 0; i < p.size(); ++i) {
+			if (cacheState[i] == toCache) {
+				evalCache->put(hashes[i], {p[i].fitnesses, p[i].footprint, p[i].infos, p[i].stats});
+			} else if (cacheState[i] != notCached) {
+				const auto &first = p[cacheState[i] - 2];
+				p[i].fitnesses = first.fitnesses;
+				p[i].footprint = first.footprint;
+				p[i].infos = first.infos;
+				p[i].stats = first.stats;
+				countCacheLookups(0, 1);  // its lookup was counted as a miss
+			}
+		}
+	}
+
+	// gives ind the cached results of its DNA, if any
+	bool fetchEvaluation(Individual<DNA> &ind, size_t hash) {
+		CachedEvaluation c;
+		bool hit = evalCache->get(hash, c);
+		countCacheLookups(1, hit ? 1 : 0);
+		if (!hit) return false;
+		ind.fitnesses = std::move(c.fitnesses);
+		ind.footprint = std::move(c.footprint);
+		ind.infos = std::move(c.infos);
+		ind.stats = std::move(c.stats);
+		ind.evaluated = true;
+		return true;
+	}
+
+	// evaluation of a single offspring (steady state), through the cache when enabled
+	void evaluateOffspring(Individual<DNA> &ind) {
+		if (evalCache && !evaluateAllIndividuals) {
+			size_t hash = dnaHasher(ind.dna);
+			bool cached = fetchEvaluation(ind, hash);
+			evaluateIndividual(ind);
+			if (!cached)
+				evalCache->put(hash, {ind.fitnesses, ind.footprint, ind.infos, ind.stats});
+		} else {
+			evaluateIndividual(ind);
+		}
+	}
+
+	void evaluateLocally(vector<Individual<DNA>> &p) {
+#ifdef OMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+		for (size_t i = 0; i < p.size(); ++i) evaluateIndividual(p[i]);
+	}
+
+	void evaluateLocally(vector<Individual<DNA>> &p, const vector<size_t> &indices) {
+#ifdef OMP
+#pragma omp parallel for schedule(dynamic, 1)
 #endif
+		for (size_t i = 0; i < indices.size(); ++i) evaluateIndividual(p[indices[i]]);
+	}
+
+	void evaluateIndividual(Individual<DNA> &ind) {
+		if (evaluateAllIndividuals || !ind.evaluated) {
+			auto t0 = high_resolution_clock::now();
+			ind.dna.reset();
+			evaluator(ind);
+			auto t1 = high_resolution_clock::now();
+			ind.evaluated = true;
+			double indTime = std::chrono::duration<double>(t1 - t0).count();
+			ind.evalTime = indTime;
+			ind.wasAlreadyEvaluated = false;
+		} else {
+			ind.evalTime = 0.0;
+			ind.wasAlreadyEvaluated = true;
+		}
+		if (verbosity >= 2) printIndividualStats(ind);
 	}
 
 	// "Vroum vroum"
 	void step(int nbGeneration = 1) {
 		if (!evaluator) throw std::invalid_argument("No evaluator specified");
+		if (steadyState && speciation)
+			throw std::invalid_argument("Steady state mode doesn't support speciation");
 		if (currentGeneration == 0 && procId == 0) {
 			createFolder(folder);
 			if (verbosity >= 1) printStart();
 		}
+		if (steadyState) {
+			steadyStateStep(nbGeneration);
+			return;
+		}
 		for (int nbg = 0; nbg < nbGeneration; ++nbg) {
 			newGenerationFunction();
 			auto tg0 = high_resolution_clock::now();
 			nextGeneration();
 			if (procId == 0) {
-				assert(lastGen.size());
-				if (population.size() != popSize)
-					throw std::invalid_argument("Population doesn't match the popSize param");
 				auto tg1 = high_resolution_clock::now();
-				double totalTime = std::chrono::duration<double>(tg1 - tg0).count();
-				auto tnp0 = high_resolution_clock::now();
-				if (savePopInterval > 0 && currentGeneration % savePopInterval == 0) {
-					if (savePopEnabled) savePop();
-					if (novelty && saveArchiveEnabled) saveArchive();
-				}
-				if (saveGenInterval > 0 && currentGeneration % saveGenInterval == 0) {
-					if (doSaveParetoFront) {
-						saveParetoFront();
+				finishGeneration(std::chrono::duration<double>(tg1 - tg0).count());
+			}
+			++currentGeneration;
+			checkpointIfDue();
+		}
+	}
+
+	// checkpoints are only taken between two generations (virtual ones in steady state
+	// mode), when no offspring is being evaluated
+	void checkpointIfDue() {
+		if (procId != 0 || checkpointInterval == 0) return;
+		if (currentGeneration >= lastCheckpointGeneration + checkpointInterval) checkpoint();
+	}
+
+	// stats, logs & saves, once lastGen is ready
+	void finishGeneration(double totalTime) {
+		assert(lastGen.size());
+		if (population.size() != popSize)
+			throw std::invalid_argument("Population doesn't match the popSize param");
+		auto tnp0 = high_resolution_clock::now();
+		if (savePopInterval > 0 && currentGeneration % savePopInterval == 0) {
+			if (savePopEnabled) savePop();
+			if (novelty && saveArchiveEnabled) saveArchive();
+		}
+		if (saveGenInterval > 0 && currentGeneration % saveGenInterval == 0) {
+			if (doSaveParetoFront) {
+				saveParetoFront();
+			} else {
+				saveBests(nbSavedElites);
+				if (nbSavedElites > 0) saveBests(nbSavedElites);
+			}
+		}
+		updateStats(totalTime);
+		if (verbosity >= 1) printGenStats(currentGeneration);
+		if (doSaveGenStats) saveGenStats();
+		if (doSaveIndStats) saveIndStats();
+		auto tnp1 = high_resolution_clock::now();
+		double tnp = std::chrono::duration<double>(tnp1 - tnp0).count();
+		if (verbosity >= 2) {
+			std::cout << "Time for save + next pop = " << tnp << " s." << std::endl;
+		}
+	}
+
+	/*********************************************************************************
+	 *                              STEADY STATE
+	 ********************************************************************************/
+	// In steady state mode, there is no generational barrier: as soon as an evaluation
+	// slot frees up (OpenMP thread or MPI proc), a new offspring is bred from the current
+	// population and dispatched. Each evaluated offspring then replaces the loser of a
+	// replacement tournament (unless that loser dominates it).
+	// Stats and saves are computed on "virtual generations" of popSize evaluations.
+	// When novelty is enabled, the whole population's novelty (and the archive) is
+	// updated once per virtual generation; offsprings are scored against the archive
+	// and the current population in between.
+
+	void steadyStateStep(int nbGeneration) {
+		if (nbGeneration <= 0) return;
+		steadyStateLastGen = currentGeneration + static_cast<size_t>(nbGeneration);
+		newGenerationFunction();
+		genStartTime = high_resolution_clock::now();
+		evaluate();  // what's left from the initial population, or a previous generational run
+#ifdef CLUSTER
+		if (procId != 0) {
+			MPI_requestEvaluations();  // workers only take part in evaluations
+			return;
+		}
+#endif
+		if (novelty) updateNovelty();
+		prepareSelection(population);
+		size_t nbEvals = static_cast<size_t>(nbGeneration) * popSize;
+		steadyStateNbEvals = nbEvals;
+		steadyStateMaxDispatch = steadyStateDispatchLimit(0);
+#ifdef CLUSTER
+		if (nbProcs > 1) {
+			MPI_steadyStateLoop(nbEvals);
+			return;
+		}
+#endif
+		size_t dispatched = 0;
+		updateRNGPool();
+		// Only the parents' selection and the insertion of the offspring (with the novelty
+		// against the population) are done under the lock. Breeding, evaluation and the
+		// novelty against the archive are done in parallel.
+#ifdef OMP
+#pragma omp parallel
+#endif
+		{
+			for (;;) {
+				OffspringParents parents;
+				bool done = false, wait = false;
+#ifdef OMP
+#pragma omp critical(gagaSteadyState)
+#endif
+				{
+					if (dispatched < steadyStateMaxDispatch) {
+						++dispatched;
+						parents = pickParents();
+					} else if (dispatched >= nbEvals) {
+						done = true;
 					} else {
-						saveBests(nbSavedElites);
-						if (nbSavedElites > 0) saveBests(nbSavedElites);
+						wait = true;  // for the offspring in flight, before a checkpoint
 					}
 				}
-				updateStats(totalTime);
-				if (verbosity >= 1) printGenStats(currentGeneration);
-				if (doSaveGenStats) saveGenStats();
-				if (doSaveIndStats) saveIndStats();
-				auto tnp1 = high_resolution_clock::now();
-				double tnp = std::chrono::duration<double>(tnp1 - tnp0).count();
-				if (verbosity >= 2) {
-					std::cout << "Time for save + next pop = " << tnp << " s." << std::endl;
+				if (done) break;
+				if (wait) {
+					std::this_thread::yield();
+					continue;
 				}
+				auto offspring = breed(std::move(parents));
+				evaluateOffspring(offspring);
+				auto knn = archiveNeighbours(offspring);
+#ifdef OMP
+#pragma omp critical(gagaSteadyState)
+#endif
+				insertOffspring(std::move(offspring), knn);
 			}
-			++currentGeneration;
 		}
 	}
 
-// MPI specifics
-#ifdef CLUSTER
-	void MPI_distributePopulation() {
+	// New (unevaluated) individuals are bred from the current population by crossover or
+	// mutation, in two steps: the parents' dna is copied (under the steady state lock), then
+	// crossed or mutated (outside of it). There is no cloning in steady state mode.
+	struct OffspringParents {
+		DNA first, second;  // (second is only used by crossovers)
+		bool crossover = false;
+	};
+	// Offspring are dispatched up to the end of the virtual generation after which the next
+	// checkpoint is due, and no further until it is taken: the last offspring of that
+	// generation is then inserted with none left in flight (see finishVirtualGeneration).
+	// from: nb of offspring dispatched so far, none of them being in flight.
+	size_t steadyStateDispatchLimit(size_t from) const {
+		if (procId != 0 || checkpointInterval == 0) return steadyStateNbEvals;
+		size_t dueGen =
+		    std::max(lastCheckpointGeneration + checkpointInterval, currentGeneration + 1);
+		size_t untilDue = popSize - steadyStateEvals + (dueGen - currentGeneration - 1) * popSize;
+		return std::min(steadyStateNbEvals, from + untilDue);
+	}
+
+	OffspringParents pickParents() {
+		OffspringParents parents;
+		std::uniform_real_distribution<double> d(0.0, crossoverProba + mutationProba);
+		parents.crossover = d(getRNG()) < crossoverProba;
+		parents.first = selectParent(population)->dna;
+		if (parents.crossover) parents.second = selectParent(population)->dna;
+		return parents;
+	}
+	Individual<DNA> breed(OffspringParents &&parents) {
+		if (parents.crossover) return Individual<DNA>(parents.first.crossover(parents.second));
+		Individual<DNA> offspring(std::move(parents.first));
+		offspring.dna.mutate();
+		return offspring;
+	}
+	Individual<DNA> produceOffspring() { return breed(pickParents()); }
+
+	// returns the index of the loser of a tournament: the participant dominated by the
+	// most others (paretoTournament), with the worst (rank, crowding) (nsga2Tournament)
+	// or the worst on a random objective.
+	size_t replacementTournament() {
+		std::uniform_int_distribution<size_t> dint(0, population.size() - 1);
+		static thread_local vector<size_t> participants;  // see paretoTournament
+		participants.clear();
+		for (size_t i = 0; i < tournamentSize; ++i) participants.push_back(dint(getRNG()));
+		size_t loser = participants[0];
+		if (selectionMethod() == SelectionMethod::paretoTournament) {
+			size_t mostDominated = 0;
+			for (auto i : participants) {
+				size_t nDominated = 0;
+				for (auto j : participants)
+					if (paretoDominates(population[j], population[i])) ++nDominated;
+				if (nDominated > mostDominated) {
+					mostDominated = nDominated;
+					loser = i;
+				}
+			}
+		} else if (selectionMethod() == SelectionMethod::nsga2Tournament) {
+			for (auto i : participants)
+				if (nsga2Better(population[loser], population[i])) loser = i;
+		} else {
+			std::uniform_int_distribution<size_t> dObj(0, objectiveNames.size() - 1);
+			size_t o = dObj(getRNG());
+			for (auto i : participants)
+				if (isBetter(population[loser].objectives[o], population[i].objectives[o])) loser = i;
+		}
+		return loser;
+	}
+
+	// The offspring's nearest neighbours in the archive. The archive only changes between
+	// virtual generations, under archiveMutex, so this doesn't need the steady state lock.
+	KNNHeap archiveNeighbours(Individual<DNA> &offspring) const {
+		if (!novelty) return KNNHeap(0);
+		offspring.flattenFootprint();
+		std::shared_lock<std::shared_timed_mutex> lock(archiveMutex);
+		size_t total = archive.size() + population.size();  // (constant population size)
+		if (total <= 1 || KNN == 0) return KNNHeap(0);
+		KNNHeap knn(std::min(KNN, total));
+		archiveKNN(offspring.flatFootprint, knn);
+		return knn;
+	}
+
+	// knn: see archiveNeighbours
+	void insertOffspring(Individual<DNA> &&offspring, KNNHeap &knn) {
+		if (novelty) {
+			if (knn.k > 0)
+				for (const auto &ind : population)
+					knn.push(squaredDistance(offspring.flatFootprint, ind.flatFootprint));
+			offspring.fitnesses["novelty"] = knn.avgDist();
+		}
+		const size_t nbObjectives = objectiveNames.size();
+		updateObjectives(offspring);
+		if (objectiveNames.size() != nbObjectives) padObjectives(population);
+		if (selectionMethod() == SelectionMethod::nsga2Tournament) {
+			// ranks are only refreshed once per virtual generation. In between, an offspring
+			// goes right after the worst front that dominates it.
+			offspring.paretoRank = 0;
+			offspring.crowdingDistance = 0;
+			for (const auto &i : population)
+				if (paretoDominates(i, offspring))
+					offspring.paretoRank = std::max(offspring.paretoRank, i.paretoRank + 1);
+		}
+		size_t loser = replacementTournament();
+		if (!paretoDominates(population[loser], offspring))
+			population[loser] = std::move(offspring);
+		if (++steadyStateEvals == popSize) finishVirtualGeneration();
+	}
+
+	void finishVirtualGeneration() {
+		lastGen = population;
+		auto t = high_resolution_clock::now();
+		finishGeneration(std::chrono::duration<double>(t - genStartTime).count());
+		++currentGeneration;
+		steadyStateEvals = 0;
+		// from now on, the current members count as already evaluated
+		for (auto &i : population) {
+			i.wasAlreadyEvaluated = true;
+			i.evalTime = 0.0;
+		}
+		size_t lastCheckpoint = lastCheckpointGeneration;
+		checkpointIfDue();
+		if (lastCheckpointGeneration != lastCheckpoint)  // dispatching can go on
+			steadyStateMaxDispatch = steadyStateDispatchLimit(steadyStateMaxDispatch);
+		if (currentGeneration < steadyStateLastGen) {
+			newGenerationFunction();
+			if (novelty) {
+				std::unique_lock<std::shared_timed_mutex> lock(archiveMutex);
+				updateNovelty();
+			}
+			prepareSelection(population);
+		}
+		genStartTime = high_resolution_clock::now();
+	}
+
+	// MPI messages: tasks are the population indices of the individuals to evaluate followed
+	// by their dna, results are the same indices followed by the evaluation results. The rest
+	// is either json or binary (see binaryTransfer). Nothing here depends on MPI, so that
+	// benchmarks/serialization.cpp can measure them without CLUSTER.
+	static void MPI_writeIndices(BinaryWriter &w, const vector<size_t> &indices) {
+		w.write<uint64_t>(indices.size());
+		for (auto i : indices) w.write<uint64_t>(i);
+	}
+
+	static vector<size_t> MPI_readIndices(BinaryReader &r) {
+		vector<size_t> indices(static_cast<size_t>(r.read<uint64_t>()));
+		for (auto &i : indices) i = static_cast<size_t>(r.read<uint64_t>());
+		return indices;
+	}
+
+	vector<char> MPI_packTasks(const vector<Individual<DNA>> &p, const vector<size_t> &indices) {
+		vector<char> buffer;
+		BinaryWriter w(buffer);
+		MPI_writeIndices(w, indices);
+		if (binaryTransfer) {
+			for (auto i : indices) writeDNA(w, p[i].dna);
+		} else {
+			json dnas = json::array();
+			for (auto i : indices) dnas.push_back(p[i].dna.serialize());
+			w.writeString(dnas.dump());
+		}
+		return buffer;
+	}
+
+	vector<Individual<DNA>> MPI_unpackTasks(const vector<char> &buffer,
+	                                        vector<size_t> &indices) {
+		BinaryReader r(buffer.data(), buffer.size());
+		indices = MPI_readIndices(r);
+		vector<Individual<DNA>> inds;
+		inds.reserve(indices.size());
+		if (binaryTransfer) {
+			for (size_t i = 0; i < indices.size(); ++i)
+				inds.push_back(Individual<DNA>(readDNA<DNA>(r)));
+		} else {
+			for (auto &d : json::parse(r.readString()))
+				inds.push_back(Individual<DNA>(DNA(d.template get<string>())));
+		}
+		assert(inds.size() == indices.size());
+		return inds;
+	}
+
+	vector<char> MPI_packResults(const vector<size_t> &indices,
+	                             const vector<Individual<DNA>> &inds) {
+		vector<char> buffer;
+		BinaryWriter w(buffer);
+		MPI_writeIndices(w, indices);
+		if (binaryTransfer) {
+			for (auto &i : inds) i.resultsToBinary(w);
+		} else {
+			json results = json::array();
+			for (auto &i : inds) results.push_back(i.resultsToJSON());
+			w.writeString(results.dump());
+		}
+		return buffer;
+	}
+
+	// loads the results into p and returns the indices of the individuals they belong to
+	vector<size_t> MPI_unpackResults(vector<Individual<DNA>> &p, const vector<char> &buffer) {
+		BinaryReader r(buffer.data(), buffer.size());
+		auto indices = MPI_readIndices(r);
+		if (binaryTransfer) {
+			for (auto i : indices) p[i].loadResultsFromBinary(r);
+		} else {
+			auto results = json::parse(r.readString());
+			assert(results.size() == indices.size());
+			for (size_t i = 0; i < indices.size(); ++i) p[indices[i]].loadResultsFromJSON(results[i]);
+		}
+		return indices;
+	}
+
+// MPI specifics
+#ifdef CLUSTER
+	// Only the dna of the individuals that need to be evaluated is sent to the workers,
+	// which send back their evaluation results only (see the MPI messages above).
+	//
+	// On demand scheduling: workers ask the master for small chunks of individuals
+	// and send them back once evaluated, along with a request for a new chunk.
+	// The master evaluates individuals itself while nobody is asking for work.
+	// Workers can start the next round of evaluations before the master is done with the
+	// current one, so results tags alternate between rounds.
+	enum MPITag : int { batchTag = 0, workTag = 1, stopTag = 2, resultsTag = 3 };
+	unsigned int evaluationRound = 0;
+
+	void MPI_sendBuffer(const vector<char> &buffer, int dest, int tag) {
+		MPI_Send(buffer.data(), static_cast<int>(buffer.size()), MPI_BYTE, dest, tag,
+		         MPI_COMM_WORLD);
+	}
+
+	vector<char> MPI_receiveBuffer(int source, int tag) {
+		int length;
+		MPI_Status status;
+		MPI_Probe(source, tag, MPI_COMM_WORLD, &status);  // we want to know its size
+		MPI_Get_count(&status, MPI_BYTE, &length);
+		vector<char> buffer(static_cast<size_t>(length));
+		MPI_Recv(buffer.data(), length, MPI_BYTE, status.MPI_SOURCE, status.MPI_TAG,
+		         MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+		return buffer;
+	}
+
+	// indices of the individuals that need an evaluation. The others are flagged as
+	// already evaluated right away.
+	vector<size_t> MPI_pendingEvaluations() {
+		vector<size_t> pending;
+		for (size_t i = 0; i < population.size(); ++i) {
+			if (evaluateAllIndividuals || !population[i].evaluated)
+				pending.push_back(i);
+			else
+				evaluateIndividual(population[i]);
+		}
+		return pending;
+	}
+
+	// merges the results into p and returns how many individuals there were
+	size_t MPI_mergeResults(vector<Individual<DNA>> &p, const vector<char> &buffer) {
+		auto indices = MPI_unpackResults(p, buffer);
+		for (auto i : indices) observeEvalTime(p[i]);
+		return indices.size();
+	}
+
+	void MPI_evaluateBatches() {
+		vector<size_t> indices;
 		if (procId == 0) {
 			// if we're in the master process, we send b(i)atches to the others.
 			// master will have the remaining
-			size_t batchSize = population.size() / nbProcs;
-			for (size_t dest = 1; dest < (size_t)nbProcs; ++dest) {
-				vector<Individual<DNA>> batch;
-				for (size_t ind = 0; ind < batchSize; ++ind) {
-					batch.push_back(population.back());
-					population.pop_back();
+			indices = MPI_pendingEvaluations();
+			size_t batchSize = indices.size() / static_cast<size_t>(nbProcs);
+			for (int dest = 1; dest < nbProcs; ++dest) {
+				vector<size_t> batch(indices.end() - static_cast<long>(batchSize), indices.end());
+				indices.resize(indices.size() - batchSize);
+				MPI_sendBuffer(MPI_packTasks(population, batch), dest, batchTag);
+			}
+			evaluateLocally(population, indices);
+			// master process receives all other batches
+			for (int source = 1; source < nbProcs; ++source) {
+				size_t n = MPI_mergeResults(population, MPI_receiveBuffer(source, batchTag));
+				if (verbosity >= 3) {
+					cout << endl
+					     << "Proc " << procId << " : reception of " << n
+					     << " treated individuals from proc " << source << endl;
 				}
-				string batchStr = Individual<DNA>::popToJSON(batch).dump();
-				std::vector<char> tmp(batchStr.begin(), batchStr.end());
-				tmp.push_back('\0');
-				MPI_Send(tmp.data(), tmp.size(), MPI_BYTE, dest, 0, MPI_COMM_WORLD);
 			}
 		} else {
 			// we're in a slave process, we welcome our local population !
-			int strLength;
-			MPI_Status status;
-			MPI_Probe(0, 0, MPI_COMM_WORLD, &status);  // we want to know its size
-			MPI_Get_count(&status, MPI_CHAR, &strLength);
-			char *popChar = new char[strLength + 1];
-			MPI_Recv(popChar, strLength, MPI_BYTE, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-			// and we dejsonize !
-			auto o = json::parse(popChar);
-			population = Individual<DNA>::loadPopFromJSON(o);  // welcome bros!
+			population = MPI_unpackTasks(MPI_receiveBuffer(0, batchTag), indices);
 			if (verbosity >= 3) {
 				std::ostringstream buf;
 				buf << endl
@@ -510,37 +2213,147 @@ template <typename DNA> class GA {
 				    << population.size() << " new individuals !" << endl;
 				cout << buf.str();
 			}
+			evaluateLocally(population);
+			// and we send the results to our mighty leader
+			MPI_sendBuffer(MPI_packResults(indices, population), 0, batchTag);
 		}
 	}
 
-	void MPI_receivePopulation() {
-		if (procId != 0) {  // if slave process we send our population to our mighty leader
-			string batchStr = Individual<DNA>::popToJSON(population).dump();
-			std::vector<char> tmp(batchStr.begin(), batchStr.end());
-			tmp.push_back('\0');
-			MPI_Send(tmp.data(), tmp.size(), MPI_BYTE, 0, 0, MPI_COMM_WORLD);
-		} else {
-			// master process receives all other batches
-			for (size_t source = 1; source < (size_t)nbProcs; ++source) {
-				int strLength;
-				MPI_Status status;
-				MPI_Probe(source, 0, MPI_COMM_WORLD, &status);  // determining batch size
-				MPI_Get_count(&status, MPI_CHAR, &strLength);
-				char *popChar = new char[strLength + 1];
-				MPI_Recv(popChar, strLength + 1, MPI_BYTE, source, 0, MPI_COMM_WORLD,
-				         MPI_STATUS_IGNORE);
-				// and we dejsonize!
-				auto o = json::parse(popChar);
-				vector<Individual<DNA>> batch = Individual<DNA>::loadPopFromJSON(o);
-				population.insert(population.end(), batch.begin(), batch.end());
-				delete popChar;
-				if (verbosity >= 3) {
-					cout << endl
-					     << "Proc " << procId << " : reception of " << batch.size()
-					     << " treated individuals from proc " << source << endl;
+	// nb of individuals to send in the next chunk
+	size_t MPI_nextChunkSize(size_t remaining) {
+		size_t chunk = MPIChunkSize;
+		if (chunk == 0) {
+			// adaptive: enough individuals to last MPIChunkTargetTime, but never more than
+			// a fair share of what remains, so that the last chunks stay small
+			chunk = avgEvalTime > 0 ? static_cast<size_t>(MPIChunkTargetTime / avgEvalTime) : 1;
+			size_t nbWorkers = static_cast<size_t>(nbProcs);
+			chunk = std::min(chunk, (remaining + nbWorkers - 1) / nbWorkers);
+		}
+		return std::max<size_t>(1, std::min(chunk, remaining));
+	}
+
+	void observeEvalTime(const Individual<DNA> &ind) {
+		if (!ind.wasAlreadyEvaluated)
+			avgEvalTime = avgEvalTime > 0 ? 0.9 * avgEvalTime + 0.1 * ind.evalTime : ind.evalTime;
+	}
+
+	void MPI_serveEvaluations() {
+		const int tag = resultsTag + static_cast<int>(evaluationRound++ % 2);
+		auto pending = MPI_pendingEvaluations();
+		std::deque<size_t> todo(pending.begin(), pending.end());
+		int nbActiveWorkers = nbProcs - 1;
+		while (nbActiveWorkers > 0) {
+			int flag = 1;
+			MPI_Status status;
+			if (todo.empty())
+				MPI_Probe(MPI_ANY_SOURCE, tag, MPI_COMM_WORLD, &status);
+			else
+				MPI_Iprobe(MPI_ANY_SOURCE, tag, MPI_COMM_WORLD, &flag, &status);
+			if (flag) {
+				// a worker sends its results back and asks for more work
+				int worker = status.MPI_SOURCE;
+				MPI_mergeResults(population, MPI_receiveBuffer(worker, tag));
+				if (todo.empty()) {
+					MPI_Send(nullptr, 0, MPI_BYTE, worker, stopTag, MPI_COMM_WORLD);
+					--nbActiveWorkers;
+				} else {
+					vector<size_t> chunk(MPI_nextChunkSize(todo.size()));
+					for (auto &i : chunk) {
+						i = todo.front();
+						todo.pop_front();
+					}
+					MPI_sendBuffer(MPI_packTasks(population, chunk), worker, workTag);
+					if (verbosity >= 3)
+						cerr << "Proc " << procId << " : sent " << chunk.size()
+						     << " individuals to proc " << worker << endl;
+				}
+			} else {
+				// nobody is waiting, the master does some work too
+				auto &ind = population[todo.front()];
+				todo.pop_front();
+				evaluateIndividual(ind);
+				observeEvalTime(ind);
+			}
+		}
+	}
+
+	// steady state: each worker gets one offspring at a time, stored in its slot while
+	// being evaluated
+	void MPI_steadyStateLoop(size_t nbEvals) {
+		const int tag = resultsTag + static_cast<int>(evaluationRound++ % 2);
+		vector<Individual<DNA>> slots(static_cast<size_t>(nbProcs));
+		size_t dispatched = 0;
+		int nbActiveWorkers = nbProcs - 1;
+		vector<int> idleWorkers;  // waiting for a checkpoint (see steadyStateDispatchLimit)
+		auto dispatch = [&](int worker) {
+			size_t w = static_cast<size_t>(worker);
+			++dispatched;
+			slots[w] = produceOffspring();
+			MPI_sendBuffer(MPI_packTasks(slots, {w}), worker, workTag);
+		};
+		while (nbActiveWorkers > 0) {
+			while (!idleWorkers.empty() && dispatched < steadyStateMaxDispatch) {
+				dispatch(idleWorkers.back());
+				idleWorkers.pop_back();
+			}
+			if (dispatched >= nbEvals) {
+				for (int worker : idleWorkers) {
+					MPI_Send(nullptr, 0, MPI_BYTE, worker, stopTag, MPI_COMM_WORLD);
+					--nbActiveWorkers;
+				}
+				idleWorkers.clear();
+				if (nbActiveWorkers == 0) break;
+			}
+			int flag = 1;
+			MPI_Status status;
+			if (dispatched >= steadyStateMaxDispatch)
+				MPI_Probe(MPI_ANY_SOURCE, tag, MPI_COMM_WORLD, &status);
+			else
+				MPI_Iprobe(MPI_ANY_SOURCE, tag, MPI_COMM_WORLD, &flag, &status);
+			if (flag) {
+				int worker = status.MPI_SOURCE;
+				size_t w = static_cast<size_t>(worker);
+				if (MPI_mergeResults(slots, MPI_receiveBuffer(worker, tag)) > 0) {
+					auto knn = archiveNeighbours(slots[w]);
+					insertOffspring(std::move(slots[w]), knn);
 				}
+				if (dispatched < steadyStateMaxDispatch) {
+					dispatch(worker);
+				} else if (dispatched >= nbEvals) {
+					MPI_Send(nullptr, 0, MPI_BYTE, worker, stopTag, MPI_COMM_WORLD);
+					--nbActiveWorkers;
+				} else {
+					idleWorkers.push_back(worker);
+				}
+			} else {
+				// nobody is waiting, the master does some work too
+				++dispatched;
+				auto offspring = produceOffspring();
+				evaluateOffspring(offspring);
+				observeEvalTime(offspring);
+				auto knn = archiveNeighbours(offspring);
+				insertOffspring(std::move(offspring), knn);
+			}
+		}
+	}
+
+	void MPI_requestEvaluations() {
+		const int tag = resultsTag + static_cast<int>(evaluationRound++ % 2);
+		vector<size_t> indices;
+		population.clear();
+		for (;;) {
+			// sending our results (nothing at first) is also how we ask for more
+			MPI_sendBuffer(MPI_packResults(indices, population), 0, tag);
+			MPI_Status status;
+			MPI_Probe(0, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+			if (status.MPI_TAG == stopTag) {
+				MPI_Recv(nullptr, 0, MPI_BYTE, 0, stopTag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+				break;
 			}
+			population = MPI_unpackTasks(MPI_receiveBuffer(0, workTag), indices);
+			evaluateLocally(population);
 		}
+		population.clear();
 	}
 #endif
 	/*********************************************************************************
@@ -548,10 +2361,12 @@ template <typename DNA> class GA {
 	 ********************************************************************************/
 	void classicNextGen() {
 		evaluate();
+		if (procId != 0) return;  // MPI workers only take part in evaluations
 		if (novelty) updateNovelty();
-		auto nextGen = produceNOffsprings(popSize, population, nbElites);
-		lastGen = population;
-		population = nextGen;
+		// double buffering: the offspring recycle the individuals of the generation before
+		// the last one, then the buffers are rotated. No generation is copied.
+		produceNOffsprings(popSize, population, nbElites, lastGen);
+		lastGen.swap(population);
 		if (verbosity >= 3) cerr << "Next generation ready" << endl;
 	}
 
@@ -571,6 +2386,10 @@ template <typename DNA> class GA {
 		// and in the worstFitness computations
 
 		evaluate();
+		if (procId != 0) {
+			evaluate();  // MPI workers only take part in evaluations (2 per generation)
+			return;
+		}
 
 		if (verbosity >= 3) cerr << "Starting to prepare next speciated gen" << std::endl;
 		assert(nbElites < minSpecieSize);
@@ -579,7 +2398,8 @@ template <typename DNA> class GA {
 			if (verbosity >= 3) cerr << "No specie available, creating one" << std::endl;
 			// we put all the population in one species
 			species.resize(1);
-			for (auto &i : population) species[0].push_back(&i);
+			species[0].resize(population.size());
+			std::iota(species[0].begin(), species[0].end(), 0);
 			speciationThresholds.clear();
 			speciationThresholds.resize(1);
 			speciationThresholds[0] = speciationThreshold;
@@ -592,56 +2412,53 @@ template <typename DNA> class GA {
 		for (auto &s : species) {
 			assert(s.size() > 0);
 			std::uniform_int_distribution<size_t> d(0, s.size() - 1);
-			nextLeaders.push_back(*s[d(globalRand)]);
+			nextLeaders.push_back(population[s[d(getRNG())]]);
 		}
 		if (verbosity >= 3)
 			cerr << "Found " << nextLeaders.size() << " leaders :" << std::endl;
 
 		// list of objectives
-		unordered_set<string> objectivesList;
-		for (const auto &o : population[0].fitnesses) objectivesList.insert(o.first);
-		assert(objectivesList.size() > 0);
-		if (verbosity >= 3)
-			cerr << "Found " << objectivesList.size() << " objectives" << std::endl;
+		const size_t nbObjectives = objectiveNames.size();
+		assert(nbObjectives > 0);
+		if (verbosity >= 3) cerr << "Found " << nbObjectives << " objectives" << std::endl;
 
 		// computing afjustedFitnesses
-		vector<unordered_map<string, double>> adjustedFitnessSum(species.size());
-		unordered_map<string, double> worstFitness;
-		for (const auto &o : objectivesList) {
-			worstFitness[o] = std::numeric_limits<double>::max();
-			for (const auto &i : population)
-				if (i.fitnesses.at(o) < worstFitness.at(o)) worstFitness[o] = i.fitnesses.at(o);
-		}
+		vector<vector<double>> adjustedFitnessSum(species.size(), vector<double>(nbObjectives));
+		vector<double> worstFitness(nbObjectives, std::numeric_limits<double>::max());
+		for (const auto &i : population)
+			for (size_t o = 0; o < nbObjectives; ++o)
+				worstFitness[o] = std::min(worstFitness[o], i.objectives[o]);
 		// we want to offset all the adj fitnesses so they are in the positive range
-		unordered_map<string, double> totalAdjustedFitness;
-		for (const auto &o : objectivesList) {
-			double total = 0;
-			for (size_t i = 0; i < species.size(); ++i) {
-				const auto &s = species[i];
-				assert(s.size() > 0);
-				double sum = 0;
-				for (const auto &ind : s) sum += ind->fitnesses.at(o) - worstFitness.at(o) + 1;
-				sum /= static_cast<double>(s.size());
-				total += sum;
-				adjustedFitnessSum[i][o] = sum;
+		vector<double> totalAdjustedFitness(nbObjectives, 0.0);
+		for (size_t i = 0; i < species.size(); ++i) {
+			const auto &s = species[i];
+			assert(s.size() > 0);
+			auto &sum = adjustedFitnessSum[i];
+			for (size_t ind : s)
+				for (size_t o = 0; o < nbObjectives; ++o)
+					sum[o] += population[ind].objectives[o] - worstFitness[o] + 1;
+			for (size_t o = 0; o < nbObjectives; ++o) {
+				sum[o] /= static_cast<double>(s.size());
+				totalAdjustedFitness[o] += sum[o];
 			}
-			totalAdjustedFitness[o] = total;
 		}
 		if (verbosity >= 3) {
-			for (auto &af : totalAdjustedFitness) {
-				cerr << " - total \"" << af.first << "\" = " << af.second << std::endl;
+			for (size_t o = 0; o < nbObjectives; ++o) {
+				cerr << " - total \"" << objectiveNames[o] << "\" = " << totalAdjustedFitness[o]
+				     << std::endl;
 			}
 		}
 
 		// creating the new population
 		vector<Individual<DNA>> nextGen;
-		for (const auto &o : objectivesList) {
+		auto members = speciesMembers();
+		for (size_t o = 0; o < nbObjectives; ++o) {
 			assert(totalAdjustedFitness[o] != 0);
 			for (size_t i = 0; i < species.size(); ++i) {
-				auto &s = species[i];
+				auto &s = members[i];
 				size_t nOffsprings =  // nb of offsprings the specie is authorized to produce
 				    static_cast<size_t>((static_cast<double>(popSize) /
-				                         static_cast<double>(objectivesList.size())) *
+				                         static_cast<double>(nbObjectives)) *
 				                        adjustedFitnessSum[i][o] / totalAdjustedFitness[o]);
 
 				nOffsprings = std::max(static_cast<int>(nOffsprings), 1);
@@ -651,8 +2468,8 @@ template <typename DNA> class GA {
 				               std::make_move_iterator(specieOffsprings.end()));
 			}
 		}
-		lastGen = population;
-		population = nextGen;
+		lastGen.swap(population);
+		population = std::move(nextGen);
 
 		if (verbosity >= 3)
 			cerr << "Created the new population. Population.size = " << population.size()
@@ -661,14 +2478,14 @@ template <typename DNA> class GA {
 		while (population.size() < popSize) {
 			std::uniform_int_distribution<size_t> d(0, nextLeaders.size() - 1);
 			// we just add mutated leaders
-			auto offspring = nextLeaders[d(globalRand)];
+			auto offspring = nextLeaders[d(getRNG())];
 			offspring.dna.mutate();
 			offspring.evaluated = false;
-			population.push_back(offspring);
-		}
-		while (population.size() > popSize) {
-			population.erase(population.begin());
+			population.push_back(std::move(offspring));
 		}
+		if (population.size() > popSize)
+			population.erase(population.begin(),
+			                 population.begin() + static_cast<long>(population.size() - popSize));
 		assert(population.size() == popSize);
 
 		// reevaluating the new guys
@@ -679,31 +2496,39 @@ template <typename DNA> class GA {
 		species.clear();
 		species.resize(nextLeaders.size());
 		assert(species.size() > 0);
-		for (auto &i : population) {
-			// finding the closest leader
-			size_t closestLeader = 0;
+		const size_t nbLeaders = nextLeaders.size();
+		vector<size_t> closestLeaders = findClosestLeaders(population, nextLeaders);
+		vector<size_t> snowflakes;  // individuals too far from every leader
+		for (size_t i = 0; i < population.size(); ++i) {
+			if (closestLeaders[i] < nbLeaders)
+				species[closestLeaders[i]].push_back(i);  // we found your family
+			else
+				snowflakes.push_back(i);
+		}
+		// the snowflakes found new species, in population order: each one joins the closest
+		// of the new leaders before it, or becomes a leader itself
+		vector<std::pair<const Individual<DNA> *, const Individual<DNA> *>> pairs;
+		vector<double> distances;
+		for (size_t i : snowflakes) {
+			auto &ind = population[i];
+			pairs.clear();
+			for (size_t l = nbLeaders; l < nextLeaders.size(); ++l)
+				pairs.emplace_back(&nextLeaders[l], &ind);
+			computeDistances(pairs, distances);
+			size_t closestLeader = nextLeaders.size();
 			double closestDist = std::numeric_limits<double>::max();
-			bool foundSpecie = false;
-			vector<double> distances(nextLeaders.size());
-#ifdef OMP
-#pragma omp parallel for
-#endif
-			for (size_t l = 0; l < nextLeaders.size(); ++l)
-				distances[l] = indDistanceFunction(nextLeaders[l], i);
 			for (size_t d = 0; d < distances.size(); ++d) {
-				if (distances[d] < closestDist && distances[d] < speciationThresholds[d]) {
+				if (distances[d] < closestDist &&
+				    distances[d] < speciationThresholds[nbLeaders + d]) {
 					closestDist = distances[d];
-					closestLeader = d;
-					foundSpecie = true;
+					closestLeader = nbLeaders + d;
 				}
 			}
-			if (foundSpecie) {
-				// we found your family
-				species[closestLeader].push_back(&i);
+			if (closestLeader < nextLeaders.size()) {
+				species[closestLeader].push_back(i);
 			} else {
-				// we found special snowflakes
-				nextLeaders.push_back(i);
-				species.push_back({{&i}});
+				nextLeaders.push_back(ind);
+				species.push_back({i});
 				speciationThresholds.push_back(speciationThreshold);
 			}
 		}
@@ -714,13 +2539,6 @@ template <typename DNA> class GA {
 		assert(species.size() == nextLeaders.size());
 		assert(species.size() == speciationThresholds.size());
 
-		// deleting small species
-		vector<Iptr> toReplace;  // list of individuals without specie. We need to replace
-		                         // them with new individuals. We use this because we cannot
-		                         // directly delete individuals from the population without
-		                         // invalidating all other pointers;
-		size_t cpt = 0;
-
 		if (verbosity >= 3) {
 			cerr << "Species sizes : " << std::endl;
 			for (auto &s : species) {
@@ -728,17 +2546,26 @@ template <typename DNA> class GA {
 			}
 		}
 
-		for (auto it = species.begin(); it != species.end();) {
-			if ((*it).size() < minSpecieSize && species.size() > 1) {
-				for (auto &i : *it) toReplace.push_back(i);
-				it = species.erase(it);
-				nextLeaders.erase(nextLeaders.begin() + cpt);
-				speciationThresholds.erase(speciationThresholds.begin() + cpt);
-			} else {
-				++it;
-				++cpt;
+		// deleting small species (but never the last one): their individuals will be
+		// replaced. Species, leaders and thresholds are compacted in place.
+		vector<size_t> toReplace;
+		size_t nbKept = 0;
+		for (size_t sp = 0; sp < species.size(); ++sp) {
+			const size_t nbLeft = species.size() - (sp - nbKept);
+			if (species[sp].size() < minSpecieSize && nbLeft > 1) {
+				toReplace.insert(toReplace.end(), species[sp].begin(), species[sp].end());
+				continue;
 			}
+			if (nbKept != sp) {
+				species[nbKept] = std::move(species[sp]);
+				nextLeaders[nbKept] = std::move(nextLeaders[sp]);
+				speciationThresholds[nbKept] = speciationThresholds[sp];
+			}
+			++nbKept;
 		}
+		species.resize(nbKept);
+		nextLeaders.resize(nbKept);
+		speciationThresholds.resize(nbKept);
 
 		assert(species.size() > 0);
 		assert(species.size() == nextLeaders.size());
@@ -748,31 +2575,48 @@ template <typename DNA> class GA {
 		if (verbosity >= 3) {
 			cerr << "Need to replace " << toReplace.size() << " individuals" << std::endl;
 			for (auto &i : toReplace) {
-				cerr << " : " << i << ", f = " << i->fitnesses.size() << std::endl;
+				cerr << " : " << i << ", f = " << population[i].fitnesses.size() << std::endl;
 			}
 		}
 
-// replacing all "deleted" individuals and putting them in existing species
+		// replacing all "deleted" individuals and putting them in existing species: each one
+		// becomes a copy of a member of a random specie, which has to be close enough to the
+		// leader. Candidates are drawn and checked in rounds (all the distances of a round in
+		// one batch); the ones still too far after MAX_SPECIATION_TRIES rounds become copies
+		// of their leader.
+		// /!\ Selection cannot work properly here, as lots of new individuals haven't been
+		// evaluated yet.
+		updateRNGPool();
+		members = speciesMembers();
+		for (auto &m : members) prepareSelection(m);
+		vector<size_t> targets(toReplace.size());  // species of each new individual
+		std::uniform_int_distribution<size_t> dSpecie(0, species.size() - 1);
+		for (auto &t : targets) t = dSpecie(getRNG());
+		vector<size_t> pending(toReplace.size());
+		std::iota(pending.begin(), pending.end(), 0);
+		for (unsigned int round = 0; round < MAX_SPECIATION_TRIES && !pending.empty(); ++round) {
 #ifdef OMP
-#pragma omp parallel for
+#pragma omp parallel for schedule(static)
 #endif
-		for (size_t tr = 0; tr < toReplace.size(); ++tr) {
-			auto &i = toReplace[tr];
-			// we choose one random specie and mutate individuals until the new ind can fit
-			i->evaluated = false;
-			auto selection = getSelectionMethod<vector<Iptr>>();
-			std::uniform_int_distribution<size_t> d(0, nextLeaders.size() - 1);
-			size_t leaderID = d(globalRand);
-			unsigned int c = 0;
-			do {
-				if (c++ > MAX_SPECIATION_TRIES)
-					throw std::runtime_error("Too many tries. Speciation thresholds too low.");
-				// /!\ Selection cannot work properly here, as lots of new individuals haven't
-				// been evaluated yet.
-				i->dna = selection(species[leaderID])->dna;
-			} while (indDistanceFunction(*i, nextLeaders[leaderID]) >
-			         speciationThresholds[leaderID]);
+			for (size_t k = 0; k < pending.size(); ++k) {
+				size_t r = pending[k];
+				population[toReplace[r]].recycle(selectParent(members[targets[r]])->dna);
+			}
+			pairs.resize(pending.size());
+			for (size_t k = 0; k < pending.size(); ++k)
+				pairs[k] = {&nextLeaders[targets[pending[k]]], &population[toReplace[pending[k]]]};
+			computeDistances(pairs, distances);
+			size_t nbPending = 0;
+			for (size_t k = 0; k < pending.size(); ++k)
+				if (distances[k] > speciationThresholds[targets[pending[k]]])
+					pending[nbPending++] = pending[k];
+			pending.resize(nbPending);
 		}
+		if (verbosity >= 1 && !pending.empty())
+			cerr << pending.size() << " individuals replaced by copies of their leader. "
+			     << "Speciation thresholds may be too low." << std::endl;
+		for (size_t r : pending) population[toReplace[r]].recycle(nextLeaders[targets[r]].dna);
+		for (size_t r = 0; r < toReplace.size(); ++r) species[targets[r]].push_back(toReplace[r]);
 
 		if (verbosity >= 3) cerr << "Done. " << std::endl;
 		// adjusting speciation Thresholds
@@ -803,59 +2647,134 @@ template <typename DNA> class GA {
 		}
 	}
 
+	// the individuals of each species, as pointers into the population (for selection)
+	vector<vector<Iptr>> speciesMembers() {
+		vector<vector<Iptr>> members(species.size());
+		for (size_t sp = 0; sp < species.size(); ++sp) {
+			members[sp].reserve(species[sp].size());
+			for (size_t i : species[sp]) members[sp].push_back(&population[i]);
+		}
+		return members;
+	}
+
+	// distances[k] = distance between pairs[k].first and pairs[k].second, through the batch
+	// distance function when there is one
+	void computeDistances(
+	    const vector<std::pair<const Individual<DNA> *, const Individual<DNA> *>> &pairs,
+	    vector<double> &distances) {
+		distances.resize(pairs.size());
+		if (pairs.empty()) return;
+		if (indDistanceBatchFunction) {
+			indDistanceBatchFunction(pairs, distances);
+			return;
+		}
+#ifdef OMP
+#pragma omp parallel for schedule(static)
+#endif
+		for (size_t k = 0; k < pairs.size(); ++k)
+			distances[k] = indDistanceFunction(*pairs[k].first, *pairs[k].second);
+	}
+
+	// For each individual, the closest leader under its speciation threshold (or
+	// leaders.size() if there is none). The whole individuals x leaders distance matrix is
+	// computed at once, in parallel over the individuals.
+	vector<size_t> findClosestLeaders(const vector<Individual<DNA>> &inds,
+	                                  const vector<Individual<DNA>> &leaders) {
+		const size_t nbLeaders = leaders.size();
+		vector<std::pair<const Individual<DNA> *, const Individual<DNA> *>> pairs(
+		    inds.size() * nbLeaders);
+		for (size_t i = 0; i < inds.size(); ++i)
+			for (size_t l = 0; l < nbLeaders; ++l) pairs[i * nbLeaders + l] = {&leaders[l], &inds[i]};
+		vector<double> distances;
+		computeDistances(pairs, distances);
+		vector<size_t> closest(inds.size(), nbLeaders);
+#ifdef OMP
+#pragma omp parallel for schedule(static)
+#endif
+		for (size_t i = 0; i < inds.size(); ++i) {
+			double closestDist = std::numeric_limits<double>::max();
+			const double *row = &distances[i * nbLeaders];
+			for (size_t l = 0; l < nbLeaders; ++l) {
+				if (row[l] < closestDist && row[l] < speciationThresholds[l]) {
+					closestDist = row[l];
+					closest[i] = l;
+				}
+			}
+		}
+		return closest;
+	}
+
 	template <typename I>  // I is ither Individual<DNA> or Individual<DNA>*
 	vector<Individual<DNA>> produceNOffsprings(size_t n, vector<I> &popu,
 	                                           size_t nElites = 0) {
+		vector<Individual<DNA>> nextGen;
+		produceNOffsprings(n, popu, nElites, nextGen);
+		return nextGen;
+	}
+
+	// same, in nextGen, whose individuals are recycled (see Individual::recycle). popu
+	// mustn't be nextGen.
+	template <typename I>
+	void produceNOffsprings(size_t n, vector<I> &popu, size_t nElites,
+	                        vector<Individual<DNA>> &nextGen) {
 		assert(popu.size() >= nElites);
 		if (verbosity >= 3)
 			cerr << "Going to produce " << n << " offsprings out of " << popu.size()
 			     << " individuals" << endl;
-		std::uniform_real_distribution<double> d(0.0, 1.0);
-		vector<Individual<DNA>> nextGen;
-		nextGen.reserve(n);
+		assert(objectivesUpToDate(popu));
+		nextGen.resize(n);
+		size_t s = 0;  // nb of individuals already placed
 		// Elites are placed at the begining
 		if (nElites > 0) {
-			auto elites = getElites(nElites, popu);
+			vector<string> obj;
+			for (auto &o : ref(popu[0]).fitnesses) obj.push_back(o.first);
+			auto elites = getEliteIndices(obj, nElites, popu);
 			if (verbosity >= 3) cerr << "elites.size = " << elites.size() << endl;
-			for (auto &e : elites)
-				for (auto &i : e.second) nextGen.push_back(i);
+			for (auto &e : elites) {
+				for (auto i : e.second) {
+					if (s < n)
+						nextGen[s] = ref(popu[i]);  // copy assignment, see Individual::recycle
+					else
+						nextGen.push_back(ref(popu[i]));
+					++s;
+				}
+			}
 		}
+		if (nextGen.size() < s) nextGen.resize(s);
 
-		auto selection = getSelectionMethod<vector<I>>();
+		prepareSelection(popu);
 
-		auto s = nextGen.size();
-
-		size_t nCross = crossoverProba * (n - s);
-		size_t nMut = mutationProba * (n - s);
-		nextGen.resize(s + nCross + nMut);
-#ifdef OMP
-#pragma omp parallel for
-#endif
-		for (size_t i = s; i < nCross + s; ++i) {
-			auto *p0 = selection(popu);
-			auto *p1 = selection(popu);
-			Individual<DNA> offspring(p0->dna.crossover(p1->dna));
-			nextGen[i] = offspring;
-		}
+		const size_t nLeft = n > s ? n - s : 0;
+		const size_t nCross = static_cast<size_t>(crossoverProba * static_cast<double>(nLeft));
+		const size_t nMut = static_cast<size_t>(mutationProba * static_cast<double>(nLeft));
+		updateRNGPool();
+		// crossovers, then mutants, then clones, in a single parallel loop. Each slot is
+		// written once, over the individual it recycles.
 #ifdef OMP
-#pragma omp parallel for
+#pragma omp parallel for schedule(static)
 #endif
-		for (size_t i = nCross + s; i < nMut + nCross + s; ++i) {
-			nextGen[i] = *selection(popu);
-			nextGen[i].dna.mutate();
-			nextGen[i].evaluated = false;
+		for (size_t i = s; i < n; ++i) {
+			if (i < s + nCross) {
+				auto *p0 = selectParent(popu);
+				auto *p1 = selectParent(popu);
+				nextGen[i].recycle(p0->dna.crossover(p1->dna));
+			} else if (i < s + nCross + nMut) {
+				nextGen[i].recycle(selectParent(popu)->dna);
+				nextGen[i].dna.mutate();
+			} else {
+				nextGen[i] = *selectParent(popu);  // clone
+			}
 		}
 
-		while (nextGen.size() < n) nextGen.push_back(*selection(popu));
-
-		assert(nextGen.size() == n);
-		return nextGen;
+		assert(nextGen.size() == std::max(n, s));
 	}
 
+	// a and b must be up to date with the objective registry (see updateObjectives)
 	bool paretoDominates(const Individual<DNA> &a, const Individual<DNA> &b) const {
-		for (auto &o : a.fitnesses) {
-			if (!isBetter(o.second, b.fitnesses.at(o.first))) return false;
-		}
+		assert(a.objectives.size() == b.objectives.size());
+		const size_t n = a.objectives.size();
+		for (size_t o = 0; o < n; ++o)
+			if (!isBetter(a.objectives[o], b.objectives[o])) return false;
 		return true;
 	}
 
@@ -887,40 +2806,125 @@ template <typename DNA> class GA {
 		return pareto;
 	}
 
+	// Tournaments don't allocate: participants are drawn into per thread buffers, which
+	// keep their capacity from one call to the next.
 	template <typename I> Individual<DNA> *paretoTournament(vector<I> &subPop) {
 		assert(subPop.size() > 0);
+		static thread_local vector<Individual<DNA> *> participants, front;
 		std::uniform_int_distribution<size_t> dint(0, subPop.size() - 1);
-		std::vector<Individual<DNA> *> participants;
+		participants.clear();
 		for (size_t i = 0; i < tournamentSize; ++i)
-			participants.push_back(&ref(subPop[dint(globalRand)]));
-		auto pf = getParetoFront(participants);
-		assert(pf.size() > 0);
-		std::uniform_int_distribution<size_t> dpf(0, pf.size() - 1);
-		return pf[dpf(globalRand)];
+			participants.push_back(&ref(subPop[dint(getRNG())]));
+		// the participants no other participant dominates (same front as getParetoFront)
+		front.clear();
+		for (auto *a : participants) {
+			bool dominated = false;
+			for (auto *b : participants) {
+				if (paretoDominates(*b, *a)) {
+					dominated = true;
+					break;
+				}
+			}
+			if (!dominated) front.push_back(a);
+		}
+		assert(front.size() > 0);
+		std::uniform_int_distribution<size_t> dpf(0, front.size() - 1);
+		return front[dpf(getRNG())];
+	}
+
+	// Fast non-dominated sort (Deb et al., 2002): returns the successive pareto fronts of
+	// popu (as indices in popu), front 0 being the non dominated individuals. O(MN^2)
+	template <typename I> vector<vector<size_t>> getParetoFronts(const vector<I> &popu) const {
+		const size_t N = popu.size();
+		vector<vector<size_t>> dominated(N);  // individuals dominated by i
+		vector<size_t> nbDominators(N, 0);
+		vector<vector<size_t>> fronts(1);
+		for (size_t i = 0; i < N; ++i) {
+			for (size_t j = i + 1; j < N; ++j) {
+				if (paretoDominates(ref(popu[i]), ref(popu[j]))) {
+					dominated[i].push_back(j);
+					++nbDominators[j];
+				} else if (paretoDominates(ref(popu[j]), ref(popu[i]))) {
+					dominated[j].push_back(i);
+					++nbDominators[i];
+				}
+			}
+		}
+		for (size_t i = 0; i < N; ++i)
+			if (nbDominators[i] == 0) fronts[0].push_back(i);
+		while (!fronts.back().empty()) {
+			vector<size_t> next;
+			for (auto i : fronts.back())
+				for (auto j : dominated[i])
+					if (--nbDominators[j] == 0) next.push_back(j);
+			fronts.push_back(std::move(next));
+		}
+		fronts.pop_back();
+		return fronts;
+	}
+
+	// sets the paretoRank & crowdingDistance of every individual of popu. Called once per
+	// generation, so that NSGA-II tournaments only compare cached values.
+	template <typename I> void computeNSGA2Ranks(vector<I> &popu) {
+		if (popu.empty()) return;
+		assert(objectivesUpToDate(popu));
+		auto fronts = getParetoFronts(popu);
+		for (size_t r = 0; r < fronts.size(); ++r) {
+			auto &front = fronts[r];
+			for (auto i : front) {
+				ref(popu[i]).paretoRank = r;
+				ref(popu[i]).crowdingDistance = 0;
+			}
+			for (size_t o = 0; o < objectiveNames.size(); ++o) {
+				std::sort(front.begin(), front.end(), [&](size_t a, size_t b) {
+					return ref(popu[a]).objectives[o] < ref(popu[b]).objectives[o];
+				});
+				double fMin = ref(popu[front.front()]).objectives[o];
+				double fMax = ref(popu[front.back()]).objectives[o];
+				ref(popu[front.front()]).crowdingDistance = std::numeric_limits<double>::infinity();
+				ref(popu[front.back()]).crowdingDistance = std::numeric_limits<double>::infinity();
+				if (fMax <= fMin) continue;
+				for (size_t i = 1; i + 1 < front.size(); ++i)
+					ref(popu[front[i]]).crowdingDistance +=
+					    (ref(popu[front[i + 1]]).objectives[o] - ref(popu[front[i - 1]]).objectives[o]) /
+					    (fMax - fMin);
+			}
+		}
+	}
+
+	// crowded comparison operator
+	static bool nsga2Better(const Individual<DNA> &a, const Individual<DNA> &b) {
+		return a.paretoRank < b.paretoRank ||
+		       (a.paretoRank == b.paretoRank && a.crowdingDistance > b.crowdingDistance);
+	}
+
+	// subPop must have been through computeNSGA2Ranks
+	template <typename I> Individual<DNA> *nsga2Tournament(vector<I> &subPop) {
+		assert(subPop.size() > 0);
+		std::uniform_int_distribution<size_t> dint(0, subPop.size() - 1);
+		Individual<DNA> *champion = &ref(subPop[dint(getRNG())]);
+		for (size_t i = 1; i < tournamentSize; ++i) {
+			Individual<DNA> *challenger = &ref(subPop[dint(getRNG())]);
+			if (nsga2Better(*challenger, *champion)) champion = challenger;
+		}
+		return champion;
 	}
 
 	template <typename I> Individual<DNA> *randomObjTournament(vector<I> &subPop) {
 		assert(subPop.size() > 0);
 		if (verbosity >= 3) cerr << "random obj tournament called" << endl;
 		std::uniform_int_distribution<size_t> dint(0, subPop.size() - 1);
-		std::vector<Individual<DNA> *> participants;
-		for (size_t i = 0; i < tournamentSize; ++i)
-			participants.push_back(&ref(subPop[dint(globalRand)]));
-		auto champion = participants[0];
+		Individual<DNA> *champion = &ref(subPop[dint(getRNG())]);
 		// we pick the objective randomly
-		std::string obj;
-		if (champion->fitnesses.size() == 1) {
-			obj = champion->fitnesses.begin()->first;
-		} else {
-			std::uniform_int_distribution<int> dObj(
-			    0, static_cast<int>(champion->fitnesses.size()) - 1);
-			auto it = champion->fitnesses.begin();
-			std::advance(it, dObj(globalRand));
-			obj = it->first;
+		size_t obj = 0;
+		if (champion->objectives.size() > 1) {
+			std::uniform_int_distribution<size_t> dObj(0, champion->objectives.size() - 1);
+			obj = dObj(getRNG());
 		}
 		for (size_t i = 1; i < tournamentSize; ++i) {
-			if (isBetter(participants[i]->fitnesses.at(obj), champion->fitnesses.at(obj)))
-				champion = participants[i];
+			Individual<DNA> *challenger = &ref(subPop[dint(getRNG())]);
+			if (isBetter(challenger->objectives[obj], champion->objectives[obj]))
+				champion = challenger;
 		}
 		if (verbosity >= 3) cerr << "champion found" << endl;
 		return champion;
@@ -936,8 +2940,7 @@ template <typename DNA> class GA {
 	}
 
 	template <typename I>
-	unordered_map<string, vector<Individual<DNA>>> getElites(size_t n,
-	                                                         const vector<I> &popVec) {
+	unordered_map<string, vector<Individual<DNA>>> getElites(size_t n, vector<I> &popVec) {
 		vector<string> obj;
 		for (auto &o : ref(popVec[0]).fitnesses) obj.push_back(o.first);
 		return getElites(obj, n, popVec);
@@ -949,30 +2952,49 @@ template <typename DNA> class GA {
 	}
 	template <typename I>
 	unordered_map<string, vector<Individual<DNA>>> getElites(const vector<string> &obj,
-	                                                         size_t n,
-	                                                         const vector<I> &popVec) {
+	                                                         size_t n, vector<I> &popVec) {
+		unordered_map<string, vector<Individual<DNA>>> elites;
+		for (const auto &e : getEliteIndices(obj, n, popVec)) {
+			auto &copies = elites[e.first];
+			copies.reserve(e.second.size());
+			for (auto i : e.second) copies.push_back(ref(popVec[i]));
+		}
+		return elites;
+	}
+
+	// indices in popVec of the n best individuals for each objective, best first. Only
+	// indices are sorted: nothing is copied.
+	template <typename I>
+	unordered_map<string, vector<size_t>> getEliteIndices(const vector<string> &obj, size_t n,
+	                                                      vector<I> &popVec) {
 		if (verbosity >= 3) {
 			cerr << "getElites : nbObj = " << obj.size() << " n = " << n << endl;
 		}
-		unordered_map<string, vector<Individual<DNA>>> elites;
-		for (auto &o : obj) {
-			elites[o] = vector<Individual<DNA>>();
-			elites[o].push_back(ref(popVec[0]));
-			size_t worst = 0;
-			for (size_t i = 1; i < n && i < popVec.size(); ++i) {
-				elites[o].push_back(ref(popVec[i]));
-				if (isBetter(elites[o][worst].fitnesses.at(o), ref(popVec[i]).fitnesses.at(o)))
-					worst = i;
-			}
-			for (size_t i = n; i < popVec.size(); ++i) {
-				if (isBetter(ref(popVec[i]).fitnesses.at(o), elites[o][worst].fitnesses.at(o))) {
-					elites[o][worst] = ref(popVec[i]);
-					for (size_t j = 0; j < n; ++j) {
-						if (isBetter(elites[o][worst].fitnesses.at(o), elites[o][j].fitnesses.at(o)))
-							worst = j;
-					}
-				}
-			}
+		assert(objectivesUpToDate(popVec));
+		unordered_map<string, vector<size_t>> elites;
+		const size_t k = std::min(n, popVec.size());
+		vector<size_t> order(popVec.size());
+		for (auto &objName : obj) {
+			// (an unknown name isn't registered: the objectives vectors are already sized)
+			auto id = objectiveIds.find(objName);
+			if (id == objectiveIds.end())
+				throw std::out_of_range("getElites: unknown objective " + objName);
+			const size_t o = id->second;
+			// strict order: missing objectives (NaN) last, ties broken by index
+			auto better = [&](size_t a, size_t b) {
+				double va = ref(popVec[a]).objectives[o], vb = ref(popVec[b]).objectives[o];
+				bool nanA = std::isnan(va), nanB = std::isnan(vb);
+				if (nanA != nanB) return nanB;
+				if (!nanA && isBetter(va, vb)) return true;
+				if (!nanA && isBetter(vb, va)) return false;
+				return a < b;
+			};
+			std::iota(order.begin(), order.end(), 0);
+			if (k < order.size())
+				std::nth_element(order.begin(), order.begin() + static_cast<long>(k), order.end(),
+				                 better);
+			std::sort(order.begin(), order.begin() + static_cast<long>(k), better);
+			elites[objName].assign(order.begin(), order.begin() + static_cast<long>(k));
 		}
 		return elites;
 	}
@@ -989,63 +3011,131 @@ template <typename DNA> class GA {
 	// simulation (a vector<vector<double>>).
 	// Snapshot must be of same size accross individuals.
 	// Footprint must be set in the evaluator (see examples)
+	// Distances are computed on flattened footprints (see FlatFootprint): population
+	// footprints are flattened at the beginning of updateNovelty.
 
 	static double getFootprintDistance(const fpType &f0, const fpType &f1) {
 		assert(f0.size() == f1.size());
 		double d = 0;
 		for (size_t i = 0; i < f0.size(); ++i) {
-			for (size_t j = 0; j < f0[i].size(); ++j) {
-				d += std::pow(f0[i][j] - f1[i][j], 2);
-			}
+			assert(f0[i].size() == f1[i].size());
+			d += squaredDistance(f0[i].data(), f1[i].data(), f0[i].size());
 		}
 		return sqrt(d);
 	}
+	static double getFootprintDistance(const FlatFootprint &f0, const FlatFootprint &f1) {
+		return sqrt(squaredDistance(f0, f1));
+	}
 
-	// computeAvgDist (novelty related)
-	// returns the average distance of a footprint fp to its k nearest neighbours
-	// in an archive of footprints
-	static double computeAvgDist(size_t K, const vector<Individual<DNA>> &arch,
-	                             const fpType &fp) {
-		double avgDist = 0;
-		if (arch.size() > 1) {
-			size_t k = arch.size() < K ? static_cast<size_t>(arch.size()) : K;
-			vector<Individual<DNA>> knn;
-			knn.reserve(k);
-			vector<double> knnDist;
-			knnDist.reserve(k);
-			std::pair<double, size_t> worstKnn = {getFootprintDistance(fp, arch[0].footprint),
-			                                      0};  // maxKnn is the worst among the knn
-			for (size_t i = 0; i < k; ++i) {
-				knn.push_back(arch[i]);
-				double d = getFootprintDistance(fp, arch[i].footprint);
-				knnDist.push_back(d);
-				if (d > worstKnn.first) {
-					worstKnn = {d, i};
-				}
-			}
-			for (size_t i = k; i < arch.size(); ++i) {
-				double d = getFootprintDistance(fp, arch[i].footprint);
-				if (d < worstKnn.first) {  // this one is closer than our worst knn
-					knn[worstKnn.second] = arch[i];
-					knnDist[worstKnn.second] = d;
-					worstKnn.first = d;
-					// we update maxKnn
-					for (size_t j = 0; j < knn.size(); ++j) {
-						if (knnDist[j] > worstKnn.first) {
-							worstKnn = {knnDist[j], j};
-						}
-					}
-				}
+	// average distance to the KNN among the archive and the current population
+	double computeNovelty(const FlatFootprint &fp) const {
+		size_t total = archive.size() + population.size();
+		if (total <= 1 || KNN == 0) return 0;
+		KNNHeap knn(std::min(KNN, total));
+		for (const auto &ind : population) knn.push(squaredDistance(fp, ind.flatFootprint));
+		archiveKNN(fp, knn);
+		return knn.avgDist();
+	}
+	void archiveKNN(const FlatFootprint &fp, KNNHeap &knn) const {
+		if (noveltyIndex) {
+			assert(indexedArchiveSize == archive.size());
+			archiveIndex.knn(fp, knn, noveltyIndexMaxLeafChecks);
+		} else {
+			for (const auto &e : archive) knn.push(squaredDistance(fp, e.footprint));
+		}
+	}
+
+	// inserts the new archive members in the index. Evicted entries are removed from the
+	// index as they go (see evictArchiveEntries), the whole index is only rebuilt when
+	// they outnumber the live ones.
+	void updateArchiveIndex() {
+		if (archiveIndex.nbRemoved() > archiveIndex.size()) {
+			clearArchiveIndex();
+			++archiveIndexRebuilds;
+		}
+		for (; indexedArchiveSize < archive.size(); ++indexedArchiveSize)
+			archivePointIds.push_back(archiveIndex.insert(archive[indexedArchiveSize].footprint));
+	}
+	void clearArchiveIndex() {
+		archiveIndex.clear();
+		archivePointIds.clear();
+		indexedArchiveSize = 0;
+	}
+
+	// Removes entries from the archive until it fits in maxArchiveSize, and returns how
+	// many were removed. The survivors keep their insertion order.
+	size_t evictArchiveEntries() {
+		if (maxArchiveSize == 0 || archive.size() <= maxArchiveSize) return 0;
+		const size_t n = archive.size() - maxArchiveSize;
+		vector<size_t> candidates(archive.size());
+		std::iota(candidates.begin(), candidates.end(), 0);
+		switch (archiveEviction) {
+			case ArchiveEviction::fifo:
+				candidates.resize(n);  // the archive is sorted by insertion order
+				break;
+			case ArchiveEviction::random:
+				std::shuffle(candidates.begin(), candidates.end(), getRNG());
+				candidates.resize(n);
+				break;
+			case ArchiveEviction::leastNovel:
+				std::nth_element(candidates.begin(), candidates.begin() + static_cast<long>(n),
+				                 candidates.end(), [&](size_t a, size_t b) {
+					                 return archive[a].novelty < archive[b].novelty;
+				                 });
+				candidates.resize(n);
+				break;
+			case ArchiveEviction::density: {
+				// crowding = avg distance to the KNN within the archive (computed once, so
+				// several neighbours in a crowded region can go in the same generation)
+				vector<double> crowding = archiveCrowding();
+				std::nth_element(candidates.begin(), candidates.begin() + static_cast<long>(n),
+				                 candidates.end(),
+				                 [&](size_t a, size_t b) { return crowding[a] < crowding[b]; });
+				candidates.resize(n);
+				break;
 			}
-			assert(knn.size() == k);
-			for (size_t i = 0; i < knn.size(); ++i) {
-				assert(getFootprintDistance(fp, knn[i].footprint) == knnDist[i]);
-				avgDist += knnDist[i];
+		}
+		vector<bool> evicted(archive.size(), false);
+		for (auto c : candidates) {
+			evicted[c] = true;
+			if (archive[c].id < savedArchiveId) unsavedEvictions.push_back(archive[c].id);
+			if (c < indexedArchiveSize) archiveIndex.remove(archivePointIds[c]);
+		}
+		// compaction: the indexed entries stay a prefix of the archive
+		size_t kept = 0, keptIndexed = 0;
+		for (size_t i = 0; i < archive.size(); ++i) {
+			if (evicted[i]) continue;
+			if (kept != i) archive[kept] = std::move(archive[i]);
+			if (i < indexedArchiveSize) archivePointIds[keptIndexed++] = archivePointIds[i];
+			++kept;
+		}
+		archive.resize(kept);
+		archivePointIds.resize(keptIndexed);
+		indexedArchiveSize = keptIndexed;
+		return n;
+	}
+
+	// average distance of each archive entry to its KNN within the archive
+	vector<double> archiveCrowding() {
+		if (noveltyIndex) updateArchiveIndex();
+		vector<double> crowding(archive.size());
+		const size_t k = std::min(KNN + 1, archive.size());  // + the entry itself
+#ifdef OMP
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+		for (size_t i = 0; i < archive.size(); ++i) {
+			KNNHeap knn(k);
+			if (noveltyIndex) {
+				archiveIndex.knn(archive[i].footprint, knn, noveltyIndexMaxLeafChecks);
+			} else {
+				for (const auto &e : archive)
+					knn.push(squaredDistance(archive[i].footprint, e.footprint));
 			}
-			avgDist /= static_cast<double>(knn.size());
+			crowding[i] = knn.avgDist();
 		}
-		return avgDist;
+		return crowding;
 	}
+
 	void updateNovelty() {
 		if (verbosity >= 2) {
 			cout << endl << endl;
@@ -1054,20 +3144,45 @@ template <typename DNA> class GA {
 			     << endl
 			     << endl;
 		}
+		for (auto &ind : population) ind.flattenFootprint();
+		archiveIndexRebuilds = 0;
+		if (noveltyIndex) updateArchiveIndex();
 		auto savedArchiveSize = archive.size();
-		for (auto &ind : population) {
-			archive.push_back(ind);
-		}
-		std::pair<Individual<DNA> *, double> best = {&population[0], 0};
-		vector<Individual<DNA>> toBeAdded;
-		for (auto &ind : population) {
-			double avgD = computeAvgDist(KNN, archive, ind.footprint);
+		// novelties are computed against the archive as it was at the beginning of the
+		// generation (+ the population): new entries are only appended afterwards.
+		// Each thread fills its own buffers, merged in population order afterwards.
+		struct NoveltyBuffer {
+			vector<std::pair<size_t, ArchiveEntry<DNA>>> toBeAdded;  // {pop index, entry}
+			std::pair<size_t, double> best = {0, 0};                 // {pop index, novelty}
+			char padding[64];
+		};
+		size_t nbThreads = 1;
+#ifdef OMP
+		nbThreads = static_cast<size_t>(omp_get_max_threads());
+#endif
+		vector<NoveltyBuffer> buffers(nbThreads);
+		vector<string> outputs(verbosity >= 2 ? population.size() : 0);
+		const size_t noveltyId = getObjectiveId("novelty");
+		padObjectives(population);
+#ifdef OMP
+#pragma omp parallel for schedule(dynamic, 4)
+#endif
+		for (size_t i = 0; i < population.size(); ++i) {
+			auto &ind = population[i];
+			size_t t = 0;
+#ifdef OMP
+			t = static_cast<size_t>(omp_get_thread_num());
+#endif
+			auto &buffer = buffers[t];
+			double avgD = computeNovelty(ind.flatFootprint);
 			bool added = false;
 			if (avgD > minNoveltyForArchive) {
-				toBeAdded.push_back(ind);
+				buffer.toBeAdded.emplace_back(i, ArchiveEntry<DNA>(ind, archiveDNA));
+				buffer.toBeAdded.back().second.novelty = avgD;
+				buffer.toBeAdded.back().second.generation = currentGeneration;
 				added = true;
 			}
-			if (avgD > best.second) best = {&ind, avgD};
+			if (avgD > buffer.best.second) buffer.best = {i, avgD};
 			if (verbosity >= 2) {
 				std::stringstream output;
 				output << GREY << " ❯ " << endl
@@ -1077,16 +3192,36 @@ template <typename DNA> class GA {
 				if (verbosity >= 3)
 					output << "Footprint was : " << footprintToString(ind.footprint);
 				output << endl;
-				std::cout << output.str();
+				outputs[i] = output.str();
 			}
 			ind.fitnesses["novelty"] = avgD;
+			ind.objectives[noveltyId] = avgD;
+		}
+		for (const auto &o : outputs) std::cout << o;
+
+		vector<std::pair<size_t, ArchiveEntry<DNA>>> toBeAdded;
+		std::pair<size_t, double> bestNovelty = {0, 0};
+		for (auto &b : buffers) {
+			for (auto &e : b.toBeAdded) toBeAdded.push_back(std::move(e));
+			if (b.best.second > bestNovelty.second ||
+			    (b.best.second == bestNovelty.second && b.best.first < bestNovelty.first))
+				bestNovelty = b.best;
 		}
-		archive.resize(savedArchiveSize);
-		archive.insert(std::end(archive), std::begin(toBeAdded), std::end(toBeAdded));
+		std::sort(toBeAdded.begin(), toBeAdded.end(),
+		          [](const auto &a, const auto &b) { return a.first < b.first; });
+		for (auto &e : toBeAdded) {
+			e.second.id = nextArchiveId++;
+			archive.push_back(std::move(e.second));
+		}
+		archiveEvictions = evictArchiveEntries();
+		if (noveltyIndex) updateArchiveIndex();
+		std::pair<Individual<DNA> *, double> best = {&population[bestNovelty.first],
+		                                             bestNovelty.second};
 		if (verbosity >= 2) {
 			std::stringstream output;
-			output << " Added " << toBeAdded.size() << " new footprints to the archive."
-			       << std::endl
+			output << " Added " << toBeAdded.size() << " new footprints to the archive";
+			if (archiveEvictions > 0) output << ", evicted " << archiveEvictions;
+			output << "." << std::endl
 			       << "New archive size = " << archive.size() << " (was " << savedArchiveSize
 			       << ")." << std::endl;
 			std::cout << output.str() << std::endl;
@@ -1112,6 +3247,8 @@ template <typename DNA> class GA {
 				return "pareto tournament";
 			case SelectionMethod::randomObjTournament:
 				return "random objective tournament";
+			case SelectionMethod::nsga2Tournament:
+				return "NSGA-II tournament";
 		}
 		return "???";
 	}
@@ -1134,7 +3271,7 @@ template <typename DNA> class GA {
 		std::cout << "  ▹ nb of elites = " << BLUE << nbElites << NORMAL << std::endl;
 		std::cout << "  ▹ nb of tournament competitors = " << BLUE << tournamentSize << NORMAL
 		          << std::endl;
-		std::cout << "  ▹ selection = " << BLUE << selectMethodToString(selecMethod) << NORMAL
+		std::cout << "  ▹ selection = " << BLUE << selectMethodToString(selectionMethod()) << NORMAL
 		          << std::endl;
 		std::cout << "  ▹ mutation rate = " << BLUE << mutationProba << NORMAL << std::endl;
 		std::cout << "  ▹ crossover rate = " << BLUE << crossoverProba << NORMAL << std::endl;
@@ -1142,6 +3279,9 @@ template <typename DNA> class GA {
 		if (novelty) {
 			std::cout << "  ▹ novelty is " << GREEN << "enabled" << NORMAL << std::endl;
 			std::cout << "    - KNN size = " << BLUE << KNN << NORMAL << std::endl;
+			if (maxArchiveSize > 0)
+				std::cout << "    - max archive size = " << BLUE << maxArchiveSize << NORMAL
+				          << std::endl;
 		} else {
 			std::cout << "  ▹ novelty is " << RED << "disabled" << NORMAL << std::endl;
 		}
@@ -1188,10 +3328,12 @@ template <typename DNA> class GA {
 		double indTotalTime = 0.0, maxTime = 0.0;
 		int nEvals = 0;
 		int nObjs = static_cast<int>(lastGen[0].fitnesses.size());
-		for (const auto &o : lastGen[0].fitnesses) {
-			currentGenStats[o.first] = {
-			    {{"avg", 0.0}, {"worst", o.second}, {"best", o.second}}};
-		}
+		assert(objectivesUpToDate(lastGen));
+		vector<size_t> objIds;  // objectives of this generation
+		for (const auto &o : lastGen[0].fitnesses) objIds.push_back(getObjectiveId(o.first));
+		vector<double> avg(objIds.size(), 0.0), worst(objIds.size()), best(objIds.size());
+		for (size_t k = 0; k < objIds.size(); ++k)
+			worst[k] = best[k] = lastGen[0].objectives[objIds[k]];
 		// computing min, avg, max from custom individual stats
 		auto customStatsNames = lastGen[0].stats;
 		map<string, std::tuple<double, double, double>> customStats;
@@ -1225,33 +3367,63 @@ template <typename DNA> class GA {
 		}
 		for (const auto &ind : lastGen) {
 			indTotalTime += ind.evalTime;
-			for (const auto &o : ind.fitnesses) {
-				currentGenStats[o.first].at("avg") +=
-				    (o.second / static_cast<double>(lastGen.size()));
-				if (isBetter(o.second, currentGenStats[o.first].at("best")))
-					currentGenStats[o.first].at("best") = o.second;
-				if (!isBetter(o.second, currentGenStats[o.first].at("worst")))
-					currentGenStats[o.first].at("worst") = o.second;
+			for (size_t k = 0; k < objIds.size(); ++k) {
+				double v = ind.objectives[objIds[k]];
+				avg[k] += v / static_cast<double>(lastGen.size());
+				if (isBetter(v, best[k])) best[k] = v;
+				if (!isBetter(v, worst[k])) worst[k] = v;
 			}
 			if (ind.evalTime > maxTime) maxTime = ind.evalTime;
 			if (!ind.wasAlreadyEvaluated) ++nEvals;
 		}
+		for (size_t k = 0; k < objIds.size(); ++k) {
+			currentGenStats[objectiveNames[objIds[k]]] = {
+			    {{"avg", avg[k]}, {"worst", worst[k]}, {"best", best[k]}}};
+		}
 		currentGenStats["global"]["indTotalTime"] = indTotalTime;
 		currentGenStats["global"]["maxTime"] = maxTime;
 		currentGenStats["global"]["nEvals"] = nEvals;
 		currentGenStats["global"]["nObjs"] = nObjs;
+		if (novelty) {
+			currentGenStats["global"]["archiveSize"] = static_cast<double>(archive.size());
+			currentGenStats["global"]["archiveEvictions"] = static_cast<double>(archiveEvictions);
+			if (noveltyIndex)
+				currentGenStats["global"]["archiveIndexRebuilds"] =
+				    static_cast<double>(archiveIndexRebuilds);
+		}
 		if (speciation) {
 			currentGenStats["global"]["nSpecies"] = species.size();
 		}
+		if (evalCache) {
+			size_t lookups, hits;
+			{
+				std::lock_guard<std::mutex> lock(cacheStatsMutex);
+				lookups = cacheLookups;
+				hits = cacheHits;
+				cacheLookups = cacheHits = 0;
+			}
+			currentGenStats["global"]["cacheHits"] = static_cast<double>(hits);
+			currentGenStats["global"]["cacheHitRate"] =
+			    lookups > 0 ? static_cast<double>(hits) / static_cast<double>(lookups) : 0.0;
+			currentGenStats["global"]["cacheSize"] = static_cast<double>(evalCache->size());
+		}
 		genStats.push_back(currentGenStats);
+		if (genStatsHistory > 0) {
+			while (genStats.size() > genStatsHistory) {
+				genStats.pop_front();
+				++genStatsOffset;
+			}
+		}
 	}
 
  public:
 	void printGenStats(size_t n) {
 		const size_t l = 80;
+		assert(n >= genStatsOffset && n - genStatsOffset < genStats.size());
+		auto &stats = genStats[n - genStatsOffset];
 		std::cout << tableHeader(l);
 		std::ostringstream output;
-		const auto &globalStats = genStats[n].at("global");
+		const auto &globalStats = stats.at("global");
 		output << "Generation " << CYANBOLD << n << NORMAL << " ended in " << BLUE
 		       << globalStats.at("genTotalTime") << NORMAL << "s";
 		std::cout << tableCenteredText(l, output.str(), BLUEBOLD NORMAL BLUE NORMAL);
@@ -1271,7 +3443,7 @@ template <typename DNA> class GA {
 		       << "s (x" << timeRatio << " ratio)";
 		std::cout << tableCenteredText(l, output.str(), CYANBOLD NORMAL BLUE NORMAL "      ");
 		std::cout << tableSeparation(l);
-		for (const auto &o : genStats[n]) {
+		for (const auto &o : stats) {
 			if (o.first != "global" && o.first != "custom") {
 				output = std::ostringstream();
 				output << GREYBOLD << "--◇" << GREENBOLD << std::setw(10) << o.first << GREYBOLD
@@ -1284,9 +3456,9 @@ template <typename DNA> class GA {
 				                           YELLOW NORMAL GREENBOLD NORMAL);
 			}
 		}
-		if (genStats[n].count("custom")) {
+		if (stats.count("custom")) {
 			std::cout << tableSeparation(l);
-			for (const auto &o : genStats[n]["custom"]) {
+			for (const auto &o : stats["custom"]) {
 				output = std::ostringstream();
 				output << GREENBOLD << std::setw(15) << o.first << GREYBOLD << " ❯ " << NORMAL
 				       << std::setw(15) << o.second;
@@ -1364,33 +3536,38 @@ template <typename DNA> class GA {
 	 ********************************************************************************/
 	void saveBests(size_t n) {
 		if (n > 0) {
-			const vector<Individual<DNA>> &p = lastGen;
+			vector<Individual<DNA>> &p = lastGen;
 			// save n bests dnas for all objectives
 			vector<string> objectives;
 			for (auto &o : p[0].fitnesses) {
 				objectives.push_back(o.first);  // we need to know objective functions
 			}
-			auto elites = getElites(objectives, n, p);
+			// only the winners are copied, and only when the save runs in the background
+			unordered_map<string, vector<std::shared_ptr<const Individual<DNA>>>> elites;
+			for (const auto &e : getEliteIndices(objectives, n, p))
+				for (auto i : e.second) elites[e.first].push_back(saveSnapshot(p[i]));
 			std::stringstream baseName;
 			baseName << folder << "/gen" << currentGeneration;
-			mkdir(baseName.str().c_str(), 0777);
-			if (verbosity >= 3) {
-				cerr << "created directory " << baseName.str() << endl;
-			}
-			for (auto &e : elites) {
-				int id = 0;
-				for (auto &i : e.second) {
-					std::stringstream fileName;
-					fileName << baseName.str() << "/" << e.first << "_" << i.fitnesses.at(e.first)
-					         << "_" << id++ << ".dna";
-					std::ofstream fs(fileName.str());
-					if (!fs) {
-						cerr << "Cannot open the output file." << endl;
+			runSave([ elites = std::move(elites), dir = baseName.str(), v = verbosity ]() {
+				mkdir(dir.c_str(), 0777);
+				if (v >= 3) {
+					cerr << "created directory " << dir << endl;
+				}
+				for (auto &e : elites) {
+					int id = 0;
+					for (auto &i : e.second) {
+						std::stringstream fileName;
+						fileName << dir << "/" << e.first << "_" << i->fitnesses.at(e.first) << "_"
+						         << id++ << ".dna";
+						std::ofstream fs(fileName.str());
+						if (!fs) {
+							cerr << "Cannot open the output file." << endl;
+						}
+						fs << i->dna.serialize();
+						fs.close();
 					}
-					fs << i.dna.serialize();
-					fs.close();
 				}
-			}
+			});
 		}
 	}
 
@@ -1402,59 +3579,103 @@ template <typename DNA> class GA {
 		}
 
 		auto pfront = getParetoFront(pop);
+		vector<Individual<DNA>> front;
+		for (const auto &ind : pfront) front.push_back(*ind);
 		std::stringstream baseName;
 		baseName << folder << "/gen" << currentGeneration;
-		mkdir(baseName.str().c_str(), 0777);
-		if (verbosity >= 3) {
-			std::cout << "created directory " << baseName.str() << std::endl;
-		}
-
-		int id = 0;
-		for (const auto &ind : pfront) {
-			std::stringstream filename;
-			filename << baseName.str() << "/";
-			for (const auto &f : ind->fitnesses) {
-				filename << f.first << f.second << "_";
+		runSave([ front = std::move(front), dir = baseName.str(), v = verbosity ]() {
+			mkdir(dir.c_str(), 0777);
+			if (v >= 3) {
+				std::cout << "created directory " << dir << std::endl;
 			}
-			filename << id++ << ".dna";
 
-			std::ofstream fs(filename.str());
-			if (!fs) {
-				std::cerr << "Cannot open the output file.\n";
+			int id = 0;
+			for (const auto &ind : front) {
+				std::stringstream filename;
+				filename << dir << "/";
+				for (const auto &f : ind.fitnesses) {
+					filename << f.first << f.second << "_";
+				}
+				filename << id++ << ".dna";
+
+				std::ofstream fs(filename.str());
+				if (!fs) {
+					std::cerr << "Cannot open the output file.\n";
+				}
+				fs << ind.dna.serialize();
+				fs.close();
 			}
-			fs << ind->dna.serialize();
-			fs.close();
-		}
+		});
 	}
 
+	// Appends the last generation's stats to gen_stats.csv. Columns are those of the
+	// first saved generation; when a new one shows up later (nSpecies, ...) it is added
+	// at the end and the file is rewritten once, with empty cells for the previous rows.
 	void saveGenStats() {
-		std::stringstream csv;
-		std::stringstream fileName;
-		fileName << folder << "/gen_stats.csv";
-		csv << "generation";
-		if (genStats.size() > 0) {
-			for (const auto &cat : genStats[0]) {
-				std::stringstream column;
-				column << cat.first << "_";
-				for (const auto &s : cat.second) {
-					csv << "," << column.str() << s.first;
-				}
-			}
-			csv << endl;
-			for (size_t i = 0; i < genStats.size(); ++i) {
-				csv << i;
-				for (const auto &cat : genStats[i]) {
-					for (const auto &s : cat.second) {
-						csv << "," << s.second;
-					}
-				}
-				csv << endl;
+		if (genStats.empty()) return;
+		const auto &row = genStats.back();
+		const size_t nbColumns = genStatsColumns.size();
+		for (const auto &cat : row) {
+			for (const auto &st : cat.second) {
+				std::pair<string, string> c{cat.first, st.first};
+				if (std::find(genStatsColumns.begin(), genStatsColumns.end(), c) ==
+				    genStatsColumns.end())
+					genStatsColumns.push_back(c);
 			}
 		}
-		std::ofstream fs(fileName.str());
-		if (!fs) cerr << "Cannot open the output file." << endl;
-		fs << csv.str();
-		fs.close();
+		std::stringstream csvRow;
+		csvRow << genStatsOffset + genStats.size() - 1;
+		for (const auto &c : genStatsColumns) {
+			csvRow << ",";
+			auto cat = row.find(c.first);
+			if (cat == row.end()) continue;
+			auto st = cat->second.find(c.second);
+			if (st != cat->second.end()) csvRow << st->second;
+		}
+		size_t nbNewColumns = genStatsColumns.size() - nbColumns;
+		runSave([ this, fileName = folder + "/gen_stats.csv", header = genStatsHeader(),
+		          nbNewColumns, csvRow = csvRow.str() ]() {
+			if (!genStatsFile.is_open()) {
+				genStatsFile.open(fileName, std::fstream::out | std::fstream::trunc);
+				genStatsFile << header << endl;
+			} else if (nbNewColumns > 0) {
+				addGenStatsColumns(fileName, header, nbNewColumns);
+			}
+			if (!genStatsFile) cerr << "Cannot open the output file." << endl;
+			genStatsFile << csvRow << "\n";
+			if (++genStatsRowsSinceFlush >= genStatsFlushInterval) {
+				genStatsFile.flush();
+				genStatsRowsSinceFlush = 0;
+			}
+		});
+	}
+
+	string genStatsHeader() const {
+		std::stringstream header;
+		header << "generation";
+		for (const auto &c : genStatsColumns) header << "," << c.first << "_" << c.second;
+		return header.str();
+	}
+
+	// rewrites gen_stats.csv with the new header, padding the previous rows
+	void addGenStatsColumns(const string &fileName, const string &header, size_t nbNewColumns) {
+		genStatsFile.flush();  // (kept open until the new file is in place)
+		std::ifstream in(fileName);
+		if (!in) throw std::runtime_error("Cannot open " + fileName);
+		std::stringstream rewritten;
+		rewritten << header << endl;
+		string line;
+		std::getline(in, line);  // old header
+		const string padding(nbNewColumns, ',');
+		while (std::getline(in, line))
+			if (!line.empty()) rewritten << line << padding << "\n";
+		if (in.bad()) throw std::runtime_error("Cannot read " + fileName);
+		in.close();
+		const string contents = rewritten.str();
+		writeFileAtomically(fileName, vector<char>(contents.begin(), contents.end()));
+		genStatsFile.close();
+		genStatsFile.open(fileName, std::fstream::out | std::fstream::app);
+		if (!genStatsFile) throw std::runtime_error("Cannot open " + fileName);
 	}
 
 	// gen, idInd, fit0, fit1, time
@@ -1477,11 +3698,13 @@ template <typename DNA> class GA {
 			for (auto &o : p.stats) csv << o.second << ",";
 			csv << p.evalTime << std::endl;
 		}
-		std::ofstream fs;
-		fs.open(fileName.str(), std::fstream::out | std::fstream::app);
-		if (!fs) cerr << "Cannot open the output file." << endl;
-		fs << csv.str();
-		fs.close();
+		runSave([ fileName = fileName.str(), csv = csv.str() ]() {
+			std::ofstream fs;
+			fs.open(fileName, std::fstream::out | std::fstream::app);
+			if (!fs) cerr << "Cannot open the output file." << endl;
+			fs << csv;
+			fs.close();
+		});
 	}
 
 	void saveIndStats_OneLinePerGen() {
@@ -1508,7 +3731,7 @@ template <typename DNA> class GA {
 
 		std::vector<int> is_on_front(lastGen.size(), false);
 
-		if (selecMethod == SelectionMethod::paretoTournament) {
+		if (selectionMethod() == SelectionMethod::paretoTournament) {
 			std::vector<Individual<DNA> *> pop;
 
 			for (auto &p : lastGen) {
@@ -1599,7 +3822,16 @@ template <typename DNA> class GA {
 	}
 
  public:
+	// loads a saved population (binary snapshot or json), to be evaluated again
 	void loadPop(string file) {
+		if (PopSnapshot<DNA>::isSnapshot(file)) {
+			PopSnapshot<DNA> snapshot(file);
+			currentGeneration = snapshot.generation();
+			population.clear();
+			population = snapshot.loadAll();
+			for (auto &ind : population) ind.evaluated = false;
+			return;
+		}
 		std::ifstream t(file);
 		std::stringstream buffer;
 		buffer << t.rdbuf();
@@ -1612,37 +3844,320 @@ template <typename DNA> class GA {
 		}
 		population.clear();
 		for (auto ind : o.at("population")) {
-			population.push_back(Individual<DNA>(DNA(ind.at("dna"))));
+			population.push_back(Individual<DNA>(ind));
 			population[population.size() - 1].evaluated = false;
 		}
 	}
 
 	void savePop() {
-		json o = Individual<DNA>::popToJSON(lastGen);
-		o["evaluator"] = evaluatorName;
-		o["generation"] = currentGeneration;
 		std::stringstream baseName;
 		baseName << folder << "/gen" << currentGeneration;
-		mkdir(baseName.str().c_str(), 0777);
 		std::stringstream fileName;
-		fileName << baseName.str() << "/pop" << currentGeneration << ".pop";
-		std::ofstream file;
-		file.open(fileName.str());
-		file << o.dump();
-		file.close();
+		fileName << baseName.str() << "/pop" << currentGeneration
+		         << (binaryPopSave ? ".bpop" : ".pop");
+		auto pop = saveSnapshot(lastGen);
+		runSave([ pop, evaluator = evaluatorName, gen = currentGeneration, dir = baseName.str(),
+		          fileName = fileName.str(), binary = binaryPopSave ]() {
+			mkdir(dir.c_str(), 0777);
+			std::ofstream file;
+			if (binary) {
+				auto buffer = writePopSnapshot(*pop, gen, evaluator);
+				file.open(fileName, std::ios::binary);
+				file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+			} else {
+				json o = Individual<DNA>::popToJSON(*pop);
+				o["evaluator"] = evaluator;
+				o["generation"] = gen;
+				file.open(fileName);
+				file << o.dump();
+			}
+			file.close();
+		});
 	}
+	// Appends the archive changes since the last save to archive.log (one json object
+	// per line: {"generation", "added": [entries], "removed": [ids]}), and saves a
+	// snapshot of the whole archive every archiveSnapshotInterval generations.
+	// See loadArchive.
 	void saveArchive() {
-		json o = Individual<DNA>::popToJSON(archive);
-		o["evaluator"] = evaluatorName;
+		// entries are cheap to copy: their DNA is shared
+		auto firstNew = std::find_if(archive.begin(), archive.end(), [&](const auto &e) {
+			return e.id >= savedArchiveId;
+		});
+		vector<ArchiveEntry<DNA>> added(firstNew, archive.end());
+		runSave([ this, added = std::move(added), removed = std::move(unsavedEvictions),
+		          gen = currentGeneration, fileName = folder + "/archive.log" ]() {
+			json addedArray = json::array();
+			for (const auto &e : added) addedArray.push_back(e.toJSON());
+			json delta;
+			delta["generation"] = gen;
+			delta["added"] = addedArray;
+			delta["removed"] = removed;
+			if (!archiveLogFile.is_open()) {
+				archiveLogFile.open(fileName, std::fstream::out | std::fstream::app);
+				if (!archiveLogFile) cerr << "Cannot open the output file." << endl;
+			}
+			archiveLogFile << delta.dump() << "\n";
+			archiveLogFile.flush();
+		});
+		savedArchiveId = nextArchiveId;
+		unsavedEvictions.clear();
+		if (archiveSnapshotInterval > 0 && currentGeneration % archiveSnapshotInterval == 0)
+			saveArchiveSnapshot();
+	}
+
+	void saveArchiveSnapshot() {
 		std::stringstream baseName;
 		baseName << folder << "/gen" << currentGeneration;
-		mkdir(baseName.str().c_str(), 0777);
 		std::stringstream fileName;
 		fileName << baseName.str() << "/archive" << currentGeneration << ".pop";
-		std::ofstream file;
-		file.open(fileName.str());
-		file << o.dump();
-		file.close();
+		runSave([ entries = saveSnapshot(archive), evaluator = evaluatorName,
+		          gen = currentGeneration, dir = baseName.str(), fileName = fileName.str() ]() {
+			json popArray = json::array();
+			for (const auto &e : *entries) popArray.push_back(e.toJSON());
+			json o;
+			o["population"] = popArray;
+			o["evaluator"] = evaluator;
+			o["generation"] = gen;
+			mkdir(dir.c_str(), 0777);
+			std::ofstream file;
+			file.open(fileName);
+			file << o.dump();
+			file.close();
+		});
+	}
+
+	// Rebuilds the archive of a saved run (runFolder = getSaveFolder() of that run) as it
+	// was at the end of a generation: latest snapshot before it + archive.log replay.
+	static vector<ArchiveEntry<DNA>> readArchive(const string &runFolder, size_t generation) {
+		vector<ArchiveEntry<DNA>> res;
+		size_t snapshotGen = 0;
+		bool hasSnapshot = false;
+		for (size_t g = generation + 1; g-- > 0 && !hasSnapshot;) {
+			std::stringstream fileName;
+			fileName << runFolder << "/gen" << g << "/archive" << g << ".pop";
+			std::ifstream file(fileName.str());
+			if (!file) continue;
+			json o = json::parse(file);
+			for (const auto &e : o.at("population")) res.emplace_back(e);
+			snapshotGen = g;
+			hasSnapshot = true;
+		}
+		std::ifstream log(runFolder + "/archive.log");
+		string line;
+		while (std::getline(log, line)) {
+			if (line.empty()) continue;
+			json delta = json::parse(line);
+			size_t g = delta.at("generation");
+			if (g > generation) break;
+			if (hasSnapshot && g <= snapshotGen) continue;
+			const auto &removed = delta.at("removed");
+			if (!removed.empty()) {
+				unordered_set<size_t> ids;
+				for (const auto &id : removed) ids.insert(id.get<size_t>());
+				res.erase(std::remove_if(res.begin(), res.end(),
+				                         [&](const auto &e) { return ids.count(e.id); }),
+				          res.end());
+			}
+			for (const auto &e : delta.at("added")) res.emplace_back(e);
+		}
+		return res;
+	}
+
+	// replaces the current archive by the one of a saved run (see readArchive)
+	void loadArchive(const string &runFolder, size_t generation) {
+		archive = readArchive(runFolder, generation);
+		nextArchiveId = archive.empty() ? 0 : archive.back().id + 1;
+		savedArchiveId = nextArchiveId;
+		unsavedEvictions.clear();
+		clearArchiveIndex();
+		if (noveltyIndex) updateArchiveIndex();
+	}
+
+	/*********************************************************************************
+	 *                             CHECKPOINT / RESTART
+	 ********************************************************************************/
+	// A checkpoint holds everything a run needs to go on where it stopped: population &
+	// lastGen (with their fitnesses and evaluation flags), novelty archive, species,
+	// speciation thresholds, stats and random engines. Settings, evaluator and callbacks
+	// aren't saved: configure the GA as for the original run, then call restore().
+	string getCheckpointFile() { return folder + "/checkpoint.bin"; }
+
+	void checkpoint() { checkpoint(getCheckpointFile()); }
+	void checkpoint(const string &fileName) {
+		if (procId != 0) return;
+		flushSaves();  // so that the run's files are at least as recent as the checkpoint
+		auto engineState = [](const std::default_random_engine &e) {
+			std::stringstream ss;
+			ss << e;
+			return ss.str();
+		};
+		vector<char> buffer;
+		BinaryWriter w(buffer);
+		buffer.insert(buffer.end(), checkpointMagic, checkpointMagic + sizeof(checkpointMagic));
+		w.write<uint32_t>(checkpointVersion);
+		w.writeString(folder);
+		w.write<uint64_t>(currentGeneration);
+		w.write<uint64_t>(steadyStateEvals);
+		w.write<uint64_t>(objectiveNames.size());
+		for (const auto &o : objectiveNames) w.writeString(o);
+		for (const auto *p : {&population, &lastGen}) {
+			w.write<uint64_t>(p->size());
+			for (const auto &i : *p) i.toBinary(w);
+		}
+		// species are indices in the population
+		w.write<uint64_t>(species.size());
+		for (const auto &sp : species) {
+			w.write<uint64_t>(sp.size());
+			for (size_t i : sp) {
+				assert(i < population.size());
+				w.write<uint64_t>(i);
+			}
+		}
+		w.write<uint64_t>(speciationThresholds.size());
+		for (double t : speciationThresholds) w.write(t);
+		w.write<uint64_t>(archive.size());
+		for (const auto &e : archive) e.toBinary(w);
+		w.write<uint64_t>(nextArchiveId);
+		w.write<uint64_t>(savedArchiveId);
+		w.write<uint64_t>(unsavedEvictions.size());
+		for (auto id : unsavedEvictions) w.write<uint64_t>(id);
+		w.write<uint64_t>(genStatsOffset);
+		w.write<uint64_t>(genStats.size());
+		for (const auto &g : genStats) {
+			w.write<uint64_t>(g.size());
+			for (const auto &cat : g) {
+				w.writeString(cat.first);
+				w.writeMap(cat.second);
+			}
+		}
+		w.write<uint64_t>(genStatsColumns.size());
+		for (const auto &c : genStatsColumns) {
+			w.writeString(c.first);
+			w.writeString(c.second);
+		}
+		w.write<uint32_t>(rngSeed);
+		w.writeString(engineState(globalRand));
+		w.write<uint64_t>(rngPool.size());
+		for (const auto &t : rngPool) w.writeString(engineState(t.engine));
+		writeFileAtomically(fileName, buffer);
+		lastCheckpointGeneration = currentGeneration;
+	}
+
+	// Resumes a run from one of its checkpoints. Evaluated individuals aren't evaluated
+	// again, and the run goes on saving in its original folder: what it had saved after
+	// the checkpoint is dropped from gen_stats.csv and archive.log.
+	void restore(const string &fileName) {
+		if (procId != 0) return;
+		std::ifstream in(fileName, std::ios::binary);
+		if (!in) throw std::runtime_error("Cannot open " + fileName);
+		vector<char> buffer((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+		BinaryReader r(buffer.data(), buffer.size());
+		if (buffer.size() < sizeof(checkpointMagic) ||
+		    std::memcmp(r.skip(sizeof(checkpointMagic)), checkpointMagic,
+		                sizeof(checkpointMagic)) != 0)
+			throw std::runtime_error("Not a gaga checkpoint");
+		auto version = r.read<uint32_t>();
+		if (version != checkpointVersion)
+			throw std::runtime_error("Unsupported checkpoint version " + std::to_string(version));
+		flushSaves();
+		auto readSize = [&]() { return static_cast<size_t>(r.read<uint64_t>()); };
+		folder = r.readString();
+		currentGeneration = readSize();
+		steadyStateEvals = readSize();
+		objectiveNames.clear();
+		objectiveIds.clear();
+		for (size_t o = readSize(); o > 0; --o) getObjectiveId(r.readString());
+		for (auto *p : {&population, &lastGen}) {
+			p->clear();
+			for (size_t i = readSize(); i > 0; --i) p->push_back(Individual<DNA>::fromBinary(r));
+		}
+		species.clear();
+		species.resize(readSize());
+		for (auto &sp : species) {
+			for (size_t i = readSize(); i > 0; --i) {
+				size_t id = readSize();
+				if (id >= population.size()) throw std::runtime_error("Corrupted checkpoint");
+				sp.push_back(id);
+			}
+		}
+		speciationThresholds.clear();
+		for (size_t i = readSize(); i > 0; --i) speciationThresholds.push_back(r.read<double>());
+		archive.clear();
+		for (size_t i = readSize(); i > 0; --i)
+			archive.push_back(ArchiveEntry<DNA>::fromBinary(r));
+		nextArchiveId = readSize();
+		savedArchiveId = readSize();
+		unsavedEvictions.clear();
+		for (size_t i = readSize(); i > 0; --i) unsavedEvictions.push_back(readSize());
+		clearArchiveIndex();
+		if (noveltyIndex) updateArchiveIndex();
+		genStatsOffset = readSize();
+		genStats.clear();
+		for (size_t g = readSize(); g > 0; --g) {
+			genStats.push_back({});
+			for (size_t c = readSize(); c > 0; --c) {
+				string cat = r.readString();
+				genStats.back()[cat] = r.readMap();
+			}
+		}
+		genStatsColumns.clear();
+		for (size_t i = readSize(); i > 0; --i) {
+			string cat = r.readString();
+			genStatsColumns.push_back({cat, r.readString()});
+		}
+		rngSeed = r.read<uint32_t>();
+		std::stringstream(r.readString()) >> globalRand;
+		rngPool.resize(readSize());
+		for (auto &t : rngPool) std::stringstream(r.readString()) >> t.engine;
+		updateRNGPool();
+		updateObjectives(population);
+		updateObjectives(lastGen);
+		lastCheckpointGeneration = currentGeneration;
+		truncateRunFiles();
+	}
+
+ protected:
+	// keeps the rows (gen_stats.csv) and deltas (archive.log) of the generations before
+	// currentGeneration, and the gen_stats.csv columns known at that time
+	void truncateRunFiles() {
+		genStatsFile.close();
+		archiveLogFile.close();
+		genStatsRowsSinceFlush = 0;
+		auto rewrite = [](const string &fileName, const string &content) {
+			writeFileAtomically(fileName, vector<char>(content.begin(), content.end()));
+		};
+		string statsName = folder + "/gen_stats.csv";
+		std::ifstream stats(statsName);
+		if (stats && !genStatsColumns.empty()) {
+			std::stringstream kept;
+			kept << genStatsHeader() << "\n";
+			string line;
+			std::getline(stats, line);  // header
+			while (std::getline(stats, line)) {
+				if (line.empty()) continue;
+				if (std::stoul(line.substr(0, line.find(','))) >= currentGeneration) break;
+				size_t end = 0;  // after the last known column
+				for (size_t c = 0; c <= genStatsColumns.size() && end != string::npos; ++c)
+					end = line.find(',', c == 0 ? 0 : end + 1);
+				kept << line.substr(0, end) << "\n";
+			}
+			stats.close();
+			rewrite(statsName, kept.str());
+			genStatsFile.open(statsName, std::fstream::out | std::fstream::app);
+		}
+		string logName = folder + "/archive.log";
+		std::ifstream log(logName);
+		if (log) {
+			std::stringstream kept;
+			string line;
+			while (std::getline(log, line)) {
+				if (line.empty()) continue;
+				if (json::parse(line).at("generation").get<size_t>() >= currentGeneration) break;
+				kept << line << "\n";
+			}
+			log.close();
+			rewrite(logName, kept.str());
+		}
 	}
 };
 }  // namespace GAGA
@@ -0,0 +1,57 @@
+#include <atomic>
+#include "../gaga.hpp"
+#include "catch/catch.hpp"
+#include "dna.hpp"
+
+void lruCache() {
+	GAGA::EvaluationCache cache(2);
+	GAGA::CachedEvaluation e;
+	for (size_t h : {1, 2}) {
+		e.fitnesses["h"] = static_cast<double>(h);
+		cache.put(h, e);
+	}
+	REQUIRE(cache.get(1, e));  // 2 is now the least recently used
+	REQUIRE(e.fitnesses["h"] == 1.0);
+	cache.put(3, e);
+	REQUIRE(cache.size() == 2);
+	REQUIRE(!cache.get(2, e));
+	REQUIRE(cache.get(1, e));
+	REQUIRE(cache.get(3, e));
+}
+TEST_CASE("LRU evaluation cache", "[methods]") { lruCache(); }
+
+template <typename T> void cachedGA(bool steadyState) {
+	GAGA::GA<T> ga(0, nullptr);
+	std::atomic<size_t> nbEvals{0};
+	ga.setVerbosity(0);
+	ga.enableEvaluationCache(50);
+	ga.setDNAHasher([](const T &d) { return static_cast<size_t>(d.value); });
+	if (steadyState) ga.enableSteadyState();
+	ga.setEvaluator([&](auto &i) {
+		++nbEvals;
+		i.fitnesses["value"] = i.dna.value;
+		i.fitnesses["other"] = i.dna.value % 1000;
+	});
+	ga.setPopSize(100);
+	ga.initPopulation([]() { return T::random(); });
+	ga.step(1);
+	if (!steadyState) REQUIRE(nbEvals == 1);  // all the initial DNAs are identical
+	ga.step(10);
+	for (const auto &i : ga.population) {
+		if (!i.evaluated) continue;
+		REQUIRE(i.fitnesses.at("value") == i.dna.value);
+		REQUIRE(i.fitnesses.at("other") == i.dna.value % 1000);
+	}
+	REQUIRE(nbEvals < 11 * 100);
+	for (const auto &g : ga.getGenStats()) {
+		const auto &global = g.at("global");
+		REQUIRE(global.at("cacheHitRate") >= 0.0);
+		REQUIRE(global.at("cacheHitRate") <= 1.0);
+		REQUIRE(global.at("cacheSize") <= 50);
+	}
+	REQUIRE(ga.getGenStats().front().at("global").at("cacheHits") > 0);
+}
+TEST_CASE("Evaluations are cached", "[population]") {
+	cachedGA<IntDNA>(false);
+	cachedGA<IntDNA>(true);
+}
@@ -0,0 +1,205 @@
+#include "../gaga.hpp"
+#include "catch/catch.hpp"
+#include "dna.hpp"
+
+void distanceKernel() {
+	std::default_random_engine rnd(0);
+	std::uniform_real_distribution<double> d(-1.0, 1.0);
+	// all sizes around the vector widths, to exercise the remainder loops
+	for (size_t n = 0; n < 40; ++n) {
+		std::vector<double> a(n), b(n);
+		double expected = 0;
+		for (size_t i = 0; i < n; ++i) {
+			a[i] = d(rnd);
+			b[i] = d(rnd);
+			expected += (a[i] - b[i]) * (a[i] - b[i]);
+		}
+		REQUIRE(GAGA::squaredDistance(a.data(), b.data(), n) == Approx(expected));
+	}
+	GAGA::fpType f0 = {{0, 1, 2}, {3, 4, 5}};
+	GAGA::fpType f1 = {{1, 1, 2}, {3, 4, 3}};
+	GAGA::FlatFootprint flat0(f0), flat1(f1);
+	REQUIRE(flat0.nbSnapshots == 2);
+	REQUIRE(flat0.snapshotSize == 3);
+	REQUIRE(flat0.sameShape(flat1));
+	REQUIRE(reinterpret_cast<uintptr_t>(flat0.data.data()) % 64 == 0);
+	REQUIRE(flat0.toFpType() == f0);
+	REQUIRE(GAGA::squaredDistance(flat0, flat1) == Approx(5.0));
+}
+TEST_CASE("Footprint distance kernel", "[methods]") { distanceKernel(); }
+
+void knnHeap() {
+	GAGA::KNNHeap knn(3);
+	for (double d : {16.0, 1.0, 25.0, 4.0, 9.0, 36.0}) knn.push(d);
+	REQUIRE(knn.full());
+	REQUIRE(knn.worst() == 9.0);
+	REQUIRE(knn.avgDist() == Approx(2.0));  // (1 + 2 + 3) / 3
+}
+TEST_CASE("K nearest neighbours heap", "[methods]") { knnHeap(); }
+
+void kdTree() {
+	std::default_random_engine rnd(0);
+	std::uniform_real_distribution<double> d(-1.0, 1.0);
+	auto randomFootprint = [&]() {
+		GAGA::fpType f = {{d(rnd), d(rnd), d(rnd)}, {d(rnd), d(rnd), d(rnd)}};
+		return GAGA::FlatFootprint(f);
+	};
+	GAGA::FootprintKDTree tree(8);
+	std::vector<GAGA::FlatFootprint> points;
+	for (size_t i = 0; i < 2000; ++i) {
+		auto f = i % 2 ? points.front() : randomFootprint();  // with duplicates
+		points.push_back(f);
+		tree.insert(f);
+	}
+	REQUIRE(tree.size() == 2000);
+	for (size_t q = 0; q < 50; ++q) {
+		auto query = randomFootprint();
+		GAGA::KNNHeap bruteForce(10), exact(10), approx(10);
+		for (const auto &p : points) bruteForce.push(GAGA::squaredDistance(query, p));
+		tree.knn(query, exact);
+		tree.knn(query, approx, 1);
+		REQUIRE(exact.avgDist() == Approx(bruteForce.avgDist()));
+		REQUIRE(approx.full());
+		REQUIRE(approx.avgDist() >= exact.avgDist());
+	}
+	// removals: exact searches only see the remaining points
+	std::vector<bool> removed(points.size(), false);
+	for (size_t i = 0; i < points.size(); i += 3) {
+		tree.remove(i);
+		removed[i] = true;
+	}
+	for (size_t i = 0; i < 100; ++i) {
+		points.push_back(randomFootprint());
+		removed.push_back(false);
+		REQUIRE(tree.insert(points.back()) == points.size() - 1);
+	}
+	REQUIRE(tree.nbRemoved() == 667);
+	REQUIRE(tree.size() == 1433);
+	for (size_t q = 0; q < 50; ++q) {
+		auto query = randomFootprint();
+		GAGA::KNNHeap bruteForce(10), exact(10);
+		for (size_t i = 0; i < points.size(); ++i)
+			if (!removed[i]) bruteForce.push(GAGA::squaredDistance(query, points[i]));
+		tree.knn(query, exact);
+		REQUIRE(exact.avgDist() == Approx(bruteForce.avgDist()));
+	}
+}
+TEST_CASE("KD-tree over footprints", "[methods]") { kdTree(); }
+
+template <typename T> void noveltyGA(bool index, bool steadyState = false) {
+	GAGA::GA<T> ga(0, nullptr);
+	ga.setVerbosity(0);
+	ga.enableNovelty();
+	if (steadyState) ga.enableSteadyState();
+	if (index) {
+		ga.enableNoveltyIndex();
+		ga.disableArchiveDNA();
+	}
+	ga.setMinNoveltyForArchive(0.01);
+	ga.setEvaluator([](auto &i) {
+		i.fitnesses["value"] = i.dna.value;
+		double v = i.dna.value / 1000000.0;
+		i.footprint = {{v, 1.0 - v}, {v * v, 0.5}};
+	});
+	ga.setPopSize(100);
+	// T::random() gives identical individuals, which can collapse to a handful of values
+	// whose novelties all stay below the archive threshold
+	std::default_random_engine rnd(3);
+	ga.initPopulation([&]() {
+		T d;
+		d.value = std::uniform_int_distribution<int>(0, 1000000)(rnd);
+		d.rndEngine.seed(rnd());
+		return d;
+	});
+	ga.step(5);
+	REQUIRE(ga.population.size() == 100);
+	for (const auto &i : ga.lastGen) {
+		REQUIRE(i.fitnesses.count("novelty"));
+		REQUIRE(i.flatFootprint.size() == 4);
+	}
+	REQUIRE(!ga.getArchive().empty());
+	for (size_t i = 0; i < ga.getArchive().size(); ++i) {
+		const auto &e = ga.getArchive()[i];
+		REQUIRE(e.id == i);
+		REQUIRE(e.footprint.size() == 4);
+		REQUIRE(e.novelty > 0.01);
+		REQUIRE(static_cast<bool>(e.dna) == !index);
+	}
+}
+TEST_CASE("Novelty search", "[population]") { noveltyGA<IntDNA>(false); }
+TEST_CASE("Novelty search with an archive index", "[population]") { noveltyGA<IntDNA>(true); }
+TEST_CASE("Novelty search in steady state mode", "[population]") {
+	noveltyGA<IntDNA>(false, true);
+	noveltyGA<IntDNA>(true, true);
+}
+
+template <typename T> void boundedArchiveGA(GAGA::ArchiveEviction eviction) {
+	GAGA::GA<T> ga(0, nullptr);
+	ga.setVerbosity(0);
+	ga.enableNovelty();
+	ga.setMinNoveltyForArchive(-1.0);  // everyone is archived
+	ga.setMaxArchiveSize(150);
+	ga.setArchiveEviction(eviction);
+	ga.setEvaluator([](auto &i) {
+		i.fitnesses["value"] = i.dna.value;
+		double v = i.dna.value / 1000000.0;
+		i.footprint = {{v, 1.0 - v}};
+	});
+	ga.setPopSize(100);
+	ga.initPopulation([]() { return T::random(); });
+	ga.step(4);
+	const auto &archive = ga.getArchive();
+	REQUIRE(archive.size() == 150);
+	for (size_t i = 1; i < archive.size(); ++i) REQUIRE(archive[i - 1].id < archive[i].id);
+	if (eviction == GAGA::ArchiveEviction::fifo) REQUIRE(archive.back().id - archive[0].id == 149);
+	auto global = ga.getGenStats().back().at("global");
+	REQUIRE(global.at("archiveSize") == 150);
+	REQUIRE(global.at("archiveEvictions") > 0);
+}
+TEST_CASE("Bounded novelty archive", "[population]") {
+	boundedArchiveGA<IntDNA>(GAGA::ArchiveEviction::fifo);
+	boundedArchiveGA<IntDNA>(GAGA::ArchiveEviction::random);
+	boundedArchiveGA<IntDNA>(GAGA::ArchiveEviction::leastNovel);
+	boundedArchiveGA<IntDNA>(GAGA::ArchiveEviction::density);
+}
+
+// evicted entries are removed from the index, which gives the same novelties as a scan
+// and is only rebuilt once the removed entries outnumber the live ones
+std::vector<double> indexedBoundedArchiveGA(bool index, size_t &rebuilds) {
+	GAGA::GA<IntDNA> ga(0, nullptr);
+	ga.setVerbosity(0);
+	ga.setSeed(3);
+	ga.enableNovelty();
+	if (index) ga.enableNoveltyIndex();
+	ga.setMinNoveltyForArchive(-1.0);  // everyone is archived
+	ga.setMaxArchiveSize(300);
+	ga.setCrossoverProba(0);  // IntDNA::crossover isn't thread safe
+	ga.setEvaluator([](auto &i) {
+		i.fitnesses["value"] = i.dna.value;
+		double v = i.dna.value / 1000000.0;
+		i.footprint = {{v, 1.0 - v}};
+	});
+	ga.setPopSize(50);
+	ga.initPopulation([]() { return IntDNA::random(); });
+	ga.step(12);
+	rebuilds = 0;
+	for (const auto &s : ga.getGenStats()) {
+		const auto &global = s.at("global");
+		REQUIRE(global.count("archiveIndexRebuilds") == static_cast<size_t>(index));
+		if (index) rebuilds += static_cast<size_t>(global.at("archiveIndexRebuilds"));
+	}
+	std::vector<double> novelties;
+	for (const auto &i : ga.lastGen) novelties.push_back(i.fitnesses.at("novelty"));
+	return novelties;
+}
+TEST_CASE("Bounded novelty archive with an index", "[population]") {
+	size_t rebuilds;
+	auto scanned = indexedBoundedArchiveGA(false, rebuilds);
+	auto indexed = indexedBoundedArchiveGA(true, rebuilds);
+	// the archive is full after 6 generations, then 50 entries are evicted at each one:
+	// the removed entries outnumber the live ones every 7 generations
+	REQUIRE(rebuilds >= 1);
+	REQUIRE(rebuilds <= 2);
+	REQUIRE(indexed.size() == scanned.size());
+	for (size_t i = 0; i < indexed.size(); ++i) REQUIRE(indexed[i] == Approx(scanned[i]));
+}
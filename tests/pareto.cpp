@@ -14,3 +14,50 @@ template <typename T> void paretoGA() {
 	REQUIRE(ga.population.size() == 400);
 }
 TEST_CASE("Pareto multi-objective optimization", "[population]") { paretoGA<IntDNA>(); }
+
+template <typename T> void nsga2GA() {
+	GAGA::GA<T> ga(0, nullptr);
+	ga.setVerbosity(0);
+	ga.setSelectionMethod(GAGA::SelectionMethod::nsga2Tournament);
+	ga.setEvaluator([](auto &i) {
+		i.fitnesses["value"] = i.dna.value;
+		i.fitnesses["second"] = i.dna.value % 1000;
+	});
+	ga.setPopSize(200);
+	ga.initPopulation([]() { return T::random(); });
+	ga.step(10);
+	REQUIRE(ga.population.size() == 200);
+}
+
+void nsga2Ranks() {
+	GAGA::GA<IntDNA> ga(0, nullptr);
+	// 3 fronts: {(0,4), (2,2), (4,0)}, {(1,1), (1,1.5)}, {(0,0)}
+	std::vector<std::pair<double, double>> f = {{1, 1}, {0, 4}, {0, 0}, {2, 2}, {4, 0}, {1, 1.5}};
+	std::vector<GAGA::Individual<IntDNA>> pop(f.size());
+	for (size_t i = 0; i < f.size(); ++i) {
+		pop[i].fitnesses["a"] = f[i].first;
+		pop[i].fitnesses["b"] = f[i].second;
+	}
+	ga.updateObjectives(pop);  // (done after each evaluation in a run)
+	ga.computeNSGA2Ranks(pop);
+	REQUIRE(pop[1].paretoRank == 0);
+	REQUIRE(pop[3].paretoRank == 0);
+	REQUIRE(pop[4].paretoRank == 0);
+	REQUIRE(pop[0].paretoRank == 1);
+	REQUIRE(pop[5].paretoRank == 1);
+	REQUIRE(pop[2].paretoRank == 2);
+	// boundaries of a front are infinitely far from the others
+	REQUIRE(std::isinf(pop[1].crowdingDistance));
+	REQUIRE(std::isinf(pop[4].crowdingDistance));
+	REQUIRE(pop[3].crowdingDistance == Approx(2.0));
+	REQUIRE(ga.nsga2Better(pop[3], pop[0]));
+	REQUIRE(ga.nsga2Better(pop[4], pop[3]));
+	// objectives are registered in order and mirrored in dense vectors
+	REQUIRE(ga.objectiveNames == std::vector<std::string>({"a", "b"}));
+	REQUIRE(ga.getObjectiveId("b") == 1);
+	REQUIRE(pop[5].objectives == std::vector<double>({1, 1.5}));
+	REQUIRE(ga.paretoDominates(pop[3], pop[0]));
+	REQUIRE(!ga.paretoDominates(pop[0], pop[5]));
+}
+TEST_CASE("NSGA-II ranks and crowding distances", "[methods]") { nsga2Ranks(); }
+TEST_CASE("NSGA-II multi-objective optimization", "[population]") { nsga2GA<IntDNA>(); }
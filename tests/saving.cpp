@@ -0,0 +1,269 @@
+#include <atomic>
+#include <fstream>
+#include "../gaga.hpp"
+#include "catch/catch.hpp"
+#include "dna.hpp"
+
+static std::vector<std::vector<std::string>> readCSV(const std::string &fileName) {
+	std::vector<std::vector<std::string>> rows;
+	std::ifstream file(fileName);
+	std::string line;
+	while (std::getline(file, line)) {
+		rows.push_back({});
+		std::stringstream l(line);
+		std::string cell;
+		while (std::getline(l, cell, ',')) rows.back().push_back(cell);
+		if (!line.empty() && line.back() == ',') rows.back().push_back("");
+	}
+	return rows;
+}
+
+template <typename T> void genStatsCSV(bool async) {
+	GAGA::GA<T> ga(0, nullptr);
+	ga.setVerbosity(0);
+	if (async) ga.enableAsyncSaves();
+	ga.setGenStatsHistory(2);
+	ga.setEvaluator([](auto &i) {
+		i.fitnesses["value"] = i.dna.value;
+		i.footprint = {{i.dna.value / 1000000.0}};
+	});
+	ga.setPopSize(50);
+	ga.initPopulation([]() { return T::random(); });
+	ga.step(3);
+	ga.enableNovelty();  // adds columns (novelty, archive stats) to the next rows
+	ga.step(2);
+	REQUIRE(ga.getGenStats().size() == 2);
+	REQUIRE(ga.getGenStatsOffset() == 3);
+	ga.flushSaves();
+	auto rows = readCSV(ga.getSaveFolder() + "/gen_stats.csv");
+	REQUIRE(rows.size() == 6);
+	const auto &header = rows[0];
+	REQUIRE(header[0] == "generation");
+	auto archiveCol = std::find(header.begin(), header.end(), "global_archiveSize");
+	REQUIRE(archiveCol != header.end());
+	size_t col = static_cast<size_t>(archiveCol - header.begin());
+	for (size_t r = 1; r < rows.size(); ++r) {
+		REQUIRE(rows[r].size() == header.size());
+		REQUIRE(rows[r][0] == std::to_string(r - 1));
+		REQUIRE(rows[r][col].empty() == (r <= 3));
+	}
+}
+TEST_CASE("Generation stats are appended to gen_stats.csv", "[saving]") {
+	genStatsCSV<IntDNA>(false);
+	genStatsCSV<IntDNA>(true);
+}
+
+template <typename T> void genStatsFlush(bool async) {
+	GAGA::GA<T> ga(0, nullptr);
+	ga.setVerbosity(0);
+	if (async) ga.enableAsyncSaves();
+	ga.setGenStatsFlushInterval(10);
+	ga.setEvaluator([](auto &i) { i.fitnesses["value"] = i.dna.value; });
+	ga.setPopSize(20);
+	ga.initPopulation([]() { return T::random(); });
+	ga.step(5);
+	ga.flushSaves();  // before the 10th row
+	auto rows = readCSV(ga.getSaveFolder() + "/gen_stats.csv");
+	REQUIRE(rows.size() == 6);
+	for (size_t r = 1; r < rows.size(); ++r) REQUIRE(rows[r][0] == std::to_string(r - 1));
+}
+TEST_CASE("flushSaves writes the buffered gen_stats.csv rows", "[saving]") {
+	genStatsFlush<IntDNA>(false);
+	genStatsFlush<IntDNA>(true);
+}
+
+template <typename T> void archiveLog(bool async) {
+	GAGA::GA<T> ga(0, nullptr);
+	ga.setVerbosity(0);
+	if (async) ga.enableAsyncSaves(2);
+	ga.enableNovelty();
+	ga.setMinNoveltyForArchive(-1.0);  // everyone is archived
+	ga.setMaxArchiveSize(120);
+	ga.setArchiveEviction(GAGA::ArchiveEviction::leastNovel);
+	ga.setArchiveSnapshotInterval(3);
+	ga.setEvaluator([](auto &i) {
+		i.fitnesses["value"] = i.dna.value;
+		i.footprint = {{i.dna.value / 1000000.0}};
+	});
+	ga.setPopSize(50);
+	ga.initPopulation([]() { return T::random(); });
+	std::vector<std::vector<size_t>> archiveIds;
+	for (size_t g = 0; g < 8; ++g) {
+		ga.step(1);
+		archiveIds.push_back({});
+		for (const auto &e : ga.getArchive()) archiveIds.back().push_back(e.id);
+	}
+	ga.flushSaves();
+	for (size_t g = 0; g < archiveIds.size(); ++g) {
+		auto archive = GAGA::GA<T>::readArchive(ga.getSaveFolder(), g);
+		std::vector<size_t> ids;
+		for (const auto &e : archive) {
+			REQUIRE(e.dna);
+			REQUIRE(e.footprint.size() == 1);
+			ids.push_back(e.id);
+		}
+		REQUIRE(ids == archiveIds[g]);
+	}
+}
+TEST_CASE("The novelty archive can be rebuilt from its log", "[saving]") {
+	archiveLog<IntDNA>(false);
+}
+TEST_CASE("Saves can be written by a background thread", "[saving]") { archiveLog<IntDNA>(true); }
+
+template <typename T> void binaryPopSnapshot() {
+	GAGA::GA<T> ga(0, nullptr);
+	ga.setVerbosity(0);
+	ga.setEvaluator([](auto &i) {
+		i.fitnesses["value"] = i.dna.value;
+		i.footprint = {{i.dna.value / 1000000.0, 0.5}};
+	});
+	ga.setPopSize(40);
+	ga.initPopulation([]() { return T::random(); });
+	ga.step(2);
+	std::string fileName = ga.getSaveFolder() + "/gen1/pop1.bpop";
+	REQUIRE(GAGA::PopSnapshot<T>::isSnapshot(fileName));
+	{
+		GAGA::PopSnapshot<T> snapshot(fileName);
+		REQUIRE(snapshot.size() == ga.lastGen.size());
+		REQUIRE(snapshot.generation() == 1);
+		for (size_t i = ga.lastGen.size(); i-- > 0;) {  // random access, in any order
+			auto ind = snapshot[i];
+			REQUIRE(ind.dna.value == ga.lastGen[i].dna.value);
+			REQUIRE(ind.fitnesses == ga.lastGen[i].fitnesses);
+			REQUIRE(ind.footprint == ga.lastGen[i].footprint);
+		}
+		REQUIRE(snapshot.loadAll().size() == ga.lastGen.size());
+		REQUIRE_THROWS(snapshot.get(snapshot.size()));
+	}
+	GAGA::GA<T> loaded(0, nullptr);
+	loaded.setVerbosity(0);
+	loaded.loadPop(fileName);
+	REQUIRE(loaded.population.size() == ga.lastGen.size());
+	REQUIRE(loaded.getCurrentGeneration() == 1);
+	for (size_t i = 0; i < loaded.population.size(); ++i) {
+		REQUIRE(loaded.population[i].dna.value == ga.lastGen[i].dna.value);
+		REQUIRE(!loaded.population[i].evaluated);
+	}
+	// damaged files are rejected
+	std::string damaged = ga.getSaveFolder() + "/damaged.bpop";
+	std::ifstream in(fileName, std::ios::binary);
+	std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	std::ofstream(damaged, std::ios::binary).write(bytes.data(), 40);
+	REQUIRE_THROWS(GAGA::PopSnapshot<T>(damaged));
+	bytes[8] = 42;  // version
+	std::ofstream(damaged, std::ios::binary).write(bytes.data(),
+	                                             static_cast<std::streamsize>(bytes.size()));
+	REQUIRE_THROWS(GAGA::PopSnapshot<T>(damaged));
+}
+TEST_CASE("Populations are saved as binary snapshots", "[saving]") { binaryPopSnapshot<IntDNA>(); }
+
+template <typename T> void checkpointRestore() {
+	std::atomic<size_t> nbEvals{0};
+	auto setup = [&](GAGA::GA<T> &ga) {
+		ga.setVerbosity(0);
+		ga.enableNovelty();
+		ga.setMinNoveltyForArchive(-1.0);  // everyone is archived
+		ga.setMaxArchiveSize(120);
+		ga.setCheckpointInterval(2);
+		ga.setEvaluator([&](auto &i) {
+			++nbEvals;
+			i.fitnesses["value"] = i.dna.value;
+			i.footprint = {{i.dna.value / 1000000.0}};
+		});
+		ga.setPopSize(50);
+	};
+	GAGA::GA<T> ga(0, nullptr);
+	setup(ga);
+	ga.initPopulation([]() { return T::random(); });
+	ga.step(4);  // checkpoints after generations 1 and 3
+	auto population = ga.population;
+	auto archive = ga.getArchive();
+	auto genStats = ga.getGenStats();
+	auto rng = ga.getRNG();
+	ga.step(1);  // saved after the checkpoint, to be dropped by restore()
+	ga.flushSaves();
+
+	GAGA::GA<T> resumed(0, nullptr);
+	setup(resumed);
+	resumed.restore(ga.getCheckpointFile());
+	REQUIRE(resumed.getSaveFolder() == ga.getSaveFolder());
+	REQUIRE(resumed.getCurrentGeneration() == 4);
+	REQUIRE(resumed.population.size() == population.size());
+	size_t nbUnevaluated = 0;
+	for (size_t i = 0; i < population.size(); ++i) {
+		REQUIRE(resumed.population[i].dna.value == population[i].dna.value);
+		REQUIRE(resumed.population[i].fitnesses == population[i].fitnesses);
+		REQUIRE(resumed.population[i].evaluated == population[i].evaluated);
+		if (!population[i].evaluated) ++nbUnevaluated;
+	}
+	REQUIRE(resumed.getArchive().size() == archive.size());
+	for (size_t i = 0; i < archive.size(); ++i) {
+		REQUIRE(resumed.getArchive()[i].id == archive[i].id);
+		REQUIRE(resumed.getArchive()[i].novelty == archive[i].novelty);
+	}
+	REQUIRE(resumed.getGenStats() == genStats);
+	REQUIRE(resumed.getRNG()() == rng());
+
+	nbEvals = 0;
+	resumed.step(2);
+	REQUIRE(nbEvals >= nbUnevaluated);  // the first one only evaluates the new individuals
+	REQUIRE(nbEvals <= nbUnevaluated + 50);
+	resumed.flushSaves();
+	auto rows = readCSV(resumed.getSaveFolder() + "/gen_stats.csv");
+	REQUIRE(rows.size() == 7);
+	for (size_t r = 1; r < rows.size(); ++r) REQUIRE(rows[r][0] == std::to_string(r - 1));
+	std::vector<size_t> ids;
+	for (const auto &e : GAGA::GA<T>::readArchive(resumed.getSaveFolder(), 5)) ids.push_back(e.id);
+	std::vector<size_t> expected;
+	for (const auto &e : resumed.getArchive()) expected.push_back(e.id);
+	REQUIRE(ids == expected);
+}
+TEST_CASE("A run can be restored from a checkpoint", "[saving]") { checkpointRestore<IntDNA>(); }
+
+// in steady state mode, checkpoints are taken during a step, between virtual generations
+template <typename T> void steadyStateCheckpoint() {
+	std::atomic<size_t> nbEvals{0};
+	auto setup = [&](GAGA::GA<T> &ga) {
+		ga.setVerbosity(0);
+		ga.enableSteadyState();
+		ga.enableNovelty();
+		ga.setCheckpointInterval(2);
+		ga.setEvaluator([&](auto &i) {
+			++nbEvals;
+			i.fitnesses["value"] = i.dna.value;
+			i.footprint = {{i.dna.value / 1000000.0}};
+		});
+		ga.setPopSize(50);
+	};
+	GAGA::GA<T> ga(0, nullptr);
+	setup(ga);
+	std::vector<int> population;  // at the end of the 4th virtual generation
+	ga.setNewGenerationFunction([&]() {
+		if (ga.getCurrentGeneration() == 4)
+			for (const auto &i : ga.population) population.push_back(i.dna.value);
+	});
+	ga.initPopulation([]() { return T::random(); });
+	ga.step(5);  // checkpoints after virtual generations 1 and 3
+	REQUIRE(population.size() == 50);
+	ga.flushSaves();
+
+	GAGA::GA<T> resumed(0, nullptr);
+	setup(resumed);
+	resumed.restore(ga.getCheckpointFile());
+	REQUIRE(resumed.getCurrentGeneration() == 4);
+	REQUIRE(resumed.population.size() == population.size());
+	for (size_t i = 0; i < population.size(); ++i) {
+		REQUIRE(resumed.population[i].dna.value == population[i]);
+		REQUIRE(resumed.population[i].evaluated);  // no offspring was in flight
+	}
+	nbEvals = 0;
+	resumed.step(1);
+	REQUIRE(nbEvals == 50);
+	resumed.flushSaves();
+	auto rows = readCSV(resumed.getSaveFolder() + "/gen_stats.csv");
+	REQUIRE(rows.size() == 6);
+	for (size_t r = 1; r < rows.size(); ++r) REQUIRE(rows[r][0] == std::to_string(r - 1));
+}
+TEST_CASE("Steady state runs are checkpointed between virtual generations", "[saving]") {
+	steadyStateCheckpoint<IntDNA>();
+}
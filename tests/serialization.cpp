@@ -0,0 +1,59 @@
+#include "../gaga.hpp"
+#include "catch/catch.hpp"
+#include "dna.hpp"
+
+// same as IntDNA, with raw binary serialization
+struct BinIntDNA : public IntDNA {
+	BinIntDNA() {}
+	explicit BinIntDNA(const std::string &js) : IntDNA(js) {}
+	void serializeBinary(std::vector<char> &buffer) const {
+		const char *p = reinterpret_cast<const char *>(&value);
+		buffer.insert(buffer.end(), p, p + sizeof(value));
+	}
+	static BinIntDNA deserializeBinary(const char *data, size_t size) {
+		BinIntDNA d;
+		REQUIRE(size == sizeof(d.value));
+		std::memcpy(&d.value, data, size);
+		return d;
+	}
+};
+
+template <typename T> void binaryRoundTrip() {
+	std::vector<GAGA::Individual<T>> pop;
+	for (int i = 0; i < 10; ++i) {
+		T d;
+		d.value = i * 7;
+		GAGA::Individual<T> ind(d);
+		ind.fitnesses["value"] = i;
+		ind.fitnesses["other"] = -i * 0.5;
+		ind.footprint = {{1.0 * i, 2.0}, {3.0, 4.0 * i}};
+		ind.infos = "ind " + std::to_string(i);
+		ind.stats["s"] = i * 0.1;
+		ind.evaluated = i % 2;
+		ind.wasAlreadyEvaluated = i % 3;
+		ind.evalTime = i * 0.01;
+		pop.push_back(ind);
+	}
+	auto buffer = GAGA::Individual<T>::popToBinary(pop);
+	auto loaded = GAGA::Individual<T>::loadPopFromBinary(buffer.data(), buffer.size());
+	REQUIRE(loaded.size() == pop.size());
+	for (size_t i = 0; i < pop.size(); ++i) {
+		REQUIRE(loaded[i].dna.value == pop[i].dna.value);
+		REQUIRE(loaded[i].fitnesses == pop[i].fitnesses);
+		REQUIRE(loaded[i].footprint == pop[i].footprint);
+		REQUIRE(loaded[i].infos == pop[i].infos);
+		REQUIRE(loaded[i].stats == pop[i].stats);
+		REQUIRE(loaded[i].evaluated == pop[i].evaluated);
+		REQUIRE(loaded[i].wasAlreadyEvaluated == pop[i].wasAlreadyEvaluated);
+		REQUIRE(loaded[i].evalTime == pop[i].evalTime);
+	}
+	buffer.pop_back();
+	REQUIRE_THROWS(GAGA::Individual<T>::loadPopFromBinary(buffer.data(), buffer.size()));
+}
+
+TEST_CASE("Binary serialization of individuals", "[serialization]") {
+	REQUIRE(!GAGA::hasBinarySerialization<IntDNA>::value);
+	REQUIRE(GAGA::hasBinarySerialization<BinIntDNA>::value);
+	binaryRoundTrip<IntDNA>();
+	binaryRoundTrip<BinIntDNA>();
+}
@@ -19,3 +19,82 @@ template <typename T> void speciationGA() {
 TEST_CASE("Classic optimization with speciation enabled", "[population]") {
 	speciationGA<IntDNA>();
 }
+
+TEST_CASE("Species assignment with single and batch distances", "[population]") {
+	const size_t popSize = 60;
+	auto distance = [](const GAGA::Individual<IntDNA> &a, const GAGA::Individual<IntDNA> &b) {
+		return std::abs(a.dna.value - b.dna.value) / 1000000.0;
+	};
+	size_t batchCalls = 0;
+	auto run = [&](bool batch) {
+		GAGA::GA<IntDNA> ga(0, nullptr);
+		ga.setVerbosity(0);
+		ga.disablePopulationSave();
+		ga.setSaveGenStats(false);
+		ga.setNbSavedElites(0);
+		ga.setSaveFolder("/tmp/evos");
+		ga.setSeed(7);
+		ga.setCrossoverProba(0);  // IntDNA::crossover isn't thread safe
+		ga.setEvaluator([](auto &i) { i.fitnesses["value"] = i.dna.value; });
+		ga.enableSpeciation();
+		ga.setMinSpecieSize(5);
+		ga.setSpeciationThreshold(0.3);
+		if (batch) {
+			ga.setIndDistanceFunction(distance);  // still used to refill the species
+			ga.setIndDistanceBatchFunction([&](const auto &pairs, auto &distances) {
+				REQUIRE(distances.size() == pairs.size());
+				++batchCalls;
+				for (size_t k = 0; k < pairs.size(); ++k)
+					distances[k] = distance(*pairs[k].first, *pairs[k].second);
+			});
+		} else {
+			ga.setIndDistanceFunction(distance);
+		}
+		ga.setPopSize(popSize);
+		std::default_random_engine rnd(3);
+		ga.initPopulation([&]() {
+			IntDNA d;
+			d.value = std::uniform_int_distribution<int>(0, 1000000)(rnd);
+			return d;
+		});
+		ga.step(3);
+		REQUIRE(ga.population.size() == popSize);
+		REQUIRE(ga.species.size() > 0);
+		// every individual belongs to exactly one species
+		std::vector<size_t> count(popSize, 0);
+		for (auto &s : ga.species)
+			for (size_t i : s) {
+				REQUIRE(i < popSize);
+				++count[i];
+			}
+		REQUIRE(std::all_of(count.begin(), count.end(), [](size_t c) { return c == 1; }));
+		std::vector<int> result;
+		for (auto &i : ga.population) result.push_back(i.dna.value);
+		for (auto &s : ga.species) result.push_back(static_cast<int>(s.size()));
+		return result;
+	};
+	REQUIRE(run(false) == run(true));
+	REQUIRE(batchCalls > 0);
+}
+
+TEST_CASE("Species are refilled even when no candidate fits", "[population]") {
+	const size_t popSize = 30;
+	GAGA::GA<IntDNA> ga(0, nullptr);
+	ga.setVerbosity(0);
+	ga.disablePopulationSave();
+	ga.setSaveGenStats(false);
+	ga.setNbSavedElites(0);
+	ga.setSaveFolder("/tmp/evos");
+	ga.setEvaluator([](auto &i) { i.fitnesses["value"] = i.dna.value; });
+	ga.enableSpeciation();
+	ga.setMinSpecieSize(5);
+	// every individual founds its own species, and refilling can only fall back on copies of
+	// the last leader
+	ga.setIndDistanceFunction([](const auto &, const auto &) { return 1.0; });
+	ga.setPopSize(popSize);
+	ga.initPopulation([]() { return IntDNA::random(); });
+	REQUIRE_NOTHROW(ga.step(2));
+	REQUIRE(ga.population.size() == popSize);
+	REQUIRE(ga.species.size() == 1);
+	REQUIRE(ga.species[0].size() == popSize);
+}
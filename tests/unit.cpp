@@ -31,6 +31,79 @@ TEST_CASE("Population is initialized ok, individuals are improving", "[populatio
 	initGA<IntDNA>();
 }
 
+template <typename T> void steadyStateGA() {
+	GAGA::GA<T> ga(0, nullptr);
+	ga.setVerbosity(0);
+	ga.setMutationProba(0.7);
+	ga.setCrossoverProba(0.3);
+	ga.setEvaluator([](auto &i) { i.fitnesses["value"] = i.dna.value; });
+	ga.enableSteadyState();
+	ga.setPopSize(100);
+	ga.initPopulation([]() { return T::random(); });
+	auto best = [&]() {
+		int b = 0;
+		for (const auto &i : ga.population) b = std::max(b, i.dna.value);
+		return b;
+	};
+	// The initial individuals are all 0, and an offspring never replaces a loser that
+	// dominates it: the best individual can't be lost, so the first mutants improve the
+	// best value and it never decreases afterwards, whatever the random draws.
+	int initialBest = best();
+	ga.step(1);
+	int firstBest = best();
+	REQUIRE(ga.population.size() == 100);
+	ga.step(20);
+	for (const auto &i : ga.population) REQUIRE(i.evaluated);
+	REQUIRE(ga.population.size() == 100);
+	REQUIRE(firstBest > initialBest);
+	REQUIRE(best() >= firstBest);
+}
+
+TEST_CASE("Steady state evolution, individuals are improving", "[population]") {
+	steadyStateGA<IntDNA>();
+}
+
+template <typename G> std::vector<int> seededRun(G &ga, unsigned int seed) {
+	using T = typename G::DNA_t;
+	ga.setVerbosity(0);
+	ga.setSeed(seed);
+	ga.setCrossoverProba(0);  // IntDNA::crossover isn't thread safe
+	ga.setEvaluator([](auto &i) {
+		i.fitnesses["value"] = i.dna.value;
+		i.fitnesses["other"] = i.dna.value % 1000;
+	});
+	ga.setPopSize(100);
+	ga.initPopulation([]() { return T::random(); });
+	ga.step(10);
+	std::vector<int> values;
+	for (const auto &i : ga.population) values.push_back(i.dna.value);
+	return values;
+}
+
+template <typename T> std::vector<int> seededRun(unsigned int seed) {
+	GAGA::GA<T> ga(0, nullptr);
+	return seededRun(ga, seed);
+}
+
+TEST_CASE("Runs with the same seed are identical", "[population]") {
+	REQUIRE(seededRun<IntDNA>(42) == seededRun<IntDNA>(42));
+	REQUIRE(seededRun<IntDNA>(42) != seededRun<IntDNA>(43));
+}
+
+TEST_CASE("Compile time policies behave like the runtime ones", "[population]") {
+	GAGA::GA<IntDNA> pareto(0, nullptr), randomObj(0, nullptr), nsga2(0, nullptr);
+	randomObj.setSelectionMethod(GAGA::SelectionMethod::randomObjTournament);
+	nsga2.setSelectionMethod(GAGA::SelectionMethod::nsga2Tournament);
+	GAGA::GA<IntDNA, GAGA::Maximize, GAGA::ParetoTournamentSelection> fixedPareto(0, nullptr);
+	GAGA::GA<IntDNA, GAGA::Maximize, GAGA::RandomObjTournamentSelection> fixedRandomObj(0,
+	                                                                                     nullptr);
+	GAGA::GA<IntDNA, GAGA::Maximize, GAGA::NSGA2TournamentSelection> fixedNsga2(0, nullptr);
+	REQUIRE(seededRun(pareto, 42) == seededRun(fixedPareto, 42));
+	REQUIRE(seededRun(randomObj, 42) == seededRun(fixedRandomObj, 42));
+	REQUIRE(seededRun(nsga2, 42) == seededRun(fixedNsga2, 42));
+	REQUIRE(fixedNsga2.selectionMethod() == GAGA::SelectionMethod::nsga2Tournament);
+}
+
 void helpersMethods() {
 	const int N = 50;
 	GAGA::GA<IntDNA> ga(0, nullptr);
@@ -95,6 +168,13 @@ void helpersMethods() {
 	REQUIRE(elites["other"].size() == 1);
 	REQUIRE(elites["value"][0].dna.value == 9);
 	REQUIRE(elites["other"][0].dna.value == 0);
+	// -> as indices, best first
+	auto eliteIds = ga.getEliteIndices({"value", "other"}, 3, ga.population);
+	REQUIRE(eliteIds["value"] == std::vector<size_t>({N - 1, N - 2, N - 3}));
+	REQUIRE(eliteIds["other"] == std::vector<size_t>({0, 1, 2}));
+	REQUIRE(ga.getEliteIndices({"value"}, 2 * N, subPop)["value"].size() == 10);
+	REQUIRE_THROWS_AS(ga.getElites({"value", "typo"}, 1, subPop), std::out_of_range);
+	REQUIRE(ga.objectiveNames.size() == 2);
 }
 
 TEST_CASE("Helpers methods ok", "[methods]") { helpersMethods(); }